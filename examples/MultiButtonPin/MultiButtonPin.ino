@@ -14,67 +14,48 @@ five buttons.
    SW4      573          450 - 650
    SW5      789          700 - 870
 
+The ADC reads the pin about 1000 times a second in the background,
+triggered by Timer0 (the timer behind millis()), and the "conversion
+complete" interrupt decodes the readings. A button counts as pressed once
+10 readings in a row, 10 milliseconds, agree. loop() just collects the
+presses and releases.
+
 */
 
 #define BUTTONPIN A3
-#define NBR_BUTTONS 6  // includes "none".
 
 #include "AnalogControlPanel.h"
 
-// Which button was pressed?
-// 0 = None, 1 - 5 as above.  -1 = unknown, inconclusive reading.
-int whichButton(void)
-{
-    static const int upperBound[6] = {1023, 40, 150, 350, 650, 870};
-    static const int lowerBound[6] = { 950,  0,  50, 250, 450, 700};
-
-    InternalADC.usePin(BUTTONPIN);
-    InternalADC.speed4x();
-
-    int reading = 0;
-    for (short rdgs = 0; rdgs < 4; rdgs++)
-    {
-        reading += InternalADC.read();
-    }
-    reading = (reading + 2) / 4;  // average of 4 rounded readings.
+// Reading ranges and the button for each, in order of reading.
+// Button 0 = none pressed.
+const ACPKeyRange buttonRanges[] PROGMEM = {
+    {  0,   40, 1},
+    { 50,  150, 2},
+    {250,  350, 3},
+    {450,  650, 4},
+    {700,  870, 5},
+    {950, 1023, 0}
+};
 
-    int button = 0;
-    for (button = 0; button < NBR_BUTTONS; button++)
-    {
-        if ((reading >= lowerBound[button]) && (reading <= upperBound[button]))
-        {return button;}
-    }
-    return -1;
-}
+ACPKeypad<8> buttons(buttonRanges, 6, 10);   // up to 7 events queued
 
 void setup()
 {
     Serial.begin(9600);
     InternalADC.begin();
+    InternalADC.usePin(BUTTONPIN);
+    InternalADC.triggerOnTimer0Overflow();   // a reading every 1.024 ms
+    InternalADC.streamInto(buttons);
 }
 
 
 void loop()
 {
-    static unsigned long timeToCheck = millis() + 1000L;
-    if (millis() >= timeToCheck)
-    {
-        int button = whichButton();
-        if (button > 0)
-        {
-            Serial.print("Button ");
-            Serial.print(button);
-            Serial.println(" is pressed.");
-        }
-        else if (button == 0)
-        {
-            // Too many messages. Don't print the default state.
-            // Serial.println("No button is pressed.");
-        }
-        else // button == -1
-        {
-            Serial.println("??? inconclusive reading.");
-        }
-        timeToCheck = millis() + 1000L;
-    }
+    uint8_t event = buttons.getEvent();
+    if (event == 0) return;                  // nothing new
+
+    Serial.print("Button ");
+    Serial.print(event & ~ACP_KEY_RELEASED);
+    if (event & ACP_KEY_RELEASED) Serial.println(" released.");
+    else                          Serial.println(" pressed.");
 }
@@ -2,12 +2,13 @@
 /*
   Example of increasing "bit depth" (precision) by 2 bits by 16-fold oversampling.
 
-  Also, separately, illustrates using the "ADC conversion complete" interrupt
-  to accumulate ADC readings and maybe do simple processing of them, while
-  leaving the main loop free to do other things.
+  The library uses the "ADC conversion complete" interrupt to accumulate the
+  ADC readings in the background, leaving the main loop free to do other
+  things.
 
   12-bit depth works by oversampling and decimation, taking 16 readings and then
-  averaging them to return a value between 0 and 4092. It is slow, and ideally
+  averaging them to return a value between 0 and 4092. bitDepth11() to
+  bitDepth16() do the same for 11 to 16 bits. It is slow, and ideally
   used with input voltages that change very slowly.
 
   (In general for N bits extra, you have to accumulate 4 to the power of N readings.)
@@ -21,16 +22,15 @@
   the signal that you are measuring.
 
   One traditional way of doing this is with a small triangle wave.
-  On the Arduino this can be done by using the `tone()` function with an 
-  attenuator/integrator circuit, applying it to the ADC input pin along with
-  the sensor voltage. 
+  `InternalADC.ditherOn()` outputs a square wave on pin 3 (using Timer2), timed
+  so that one cycle spans the whole set of 16 readings. An attenuator/integrator
+  circuit turns that into a small triangle wave, applied to the ADC input pin
+  along with the sensor voltage.
 
   (Of course it can also be done with a 555. Everything can be done with a 555.)
 
-  At the default sample rate (`Rate9k()`), 16 samples are taken in 1728
-  microseconds, equivalent to a frequency of 578.7 Hz.
-  So we'd use `tone(TONE_PIN, 579)` before starting and 
-  `notone()` when the sample is ready.
+  At the clock used for oversampling (125 kHz on a 16 MHz Uno), 16 samples
+  are taken in 1664 microseconds, so ditherOn() sets about 601 Hz.
 
 
               DC Block    Attenuator/Integrator  Summing point
@@ -38,8 +38,8 @@
         +--+    10 nF      +-------+                          +--+
         |  |------||-------| 250 K |----+-------------+-------|  |  ANALOG_PIN
         +--+               +-------+    |             |       +--+  (A0 .. A7)
-        TONE_PIN (D4)                   |            +-+
-        579 Hz                          |            | | 2K2
+        DITHER PIN (D3)                 |            +-+
+        601 Hz                          |            | | 2K2
                                1 uF    ===           +-+
                                (105)    |             |       +--+
                                         |             +-------|  |  SENSOR_OUT
@@ -48,18 +48,17 @@
 
         Example Dither Circuit. Credit: "Qwerty" on the Freetronics forum.
 
-  This will provide about 6 millivolts peak-to-peak from TONE_PIN at
-  the sampling pin, using tone() from a 3.3V Arduino Pro mini running on
+  This will provide about 6 millivolts peak-to-peak from the dither pin at
+  the sampling pin, from a 3.3V Arduino Pro mini running on
   batteries at 3.1V. That is about two LSB (least significant bits) dither
   using the 3.3V supply as the reference voltage.
 
-  If you change the tone frequency significantly, the 1uF capacitor will have
-  to be changed also.
+  If you use bitDepth13() or more, the dither frequency is lower and the 1uF
+  capacitor will have to be changed also.
 
 */
 #include "AnalogControlPanel.h"
 
-#define TONE_PIN 4
 #define ANALOG_PIN A3
 
 #define REFERENCE_VOLTS 5.153
@@ -67,61 +66,18 @@
 #define READING_INTERVAL_MILLIS 1000UL
 // Interval between readings of ANALOG_PIN in milliseconds
 
-// For the ISR to tell loop that the reading is ready:
-volatile bool readingDone = false;
 
-volatile int  readSum = 0;
-// readSum accumulates the 10-bit readings by the ADC.
-// For 16 readings an int is OK.
-// For 64 (13-bit precision) or more we need a long (int32_t).
-
-
-// Definitions for the ADC conversion complete interrupt:
-#define numReadingsFor12Bit 1 * 4 * 4  // One " * 4" for each bit extra over 10
-volatile short numReadings = 0;
-
-// Our function that hardware calls when the ADC completes one (10-bit) reading:
-void accumulateReadingsISR(void)
-{
-  // accumulate 16 readings.
-  if (numReadings < numReadingsFor12Bit) 
-  {
-    readSum += InternalADC.getLastReading();
-    numReadings++;
-  }
-  if (numReadings == numReadingsFor12Bit)
-  {readingDone = true;}
-}
-
-void startReadings(void)
-{
-  // Reset the sum and count of readings, start the ADC
-  readSum = 0;
-  numReadings = 0;
-  InternalADC.freeRunningMode();  // Get the ADC to take readings continuously.
-  InternalADC.interruptOnDone();
-  InternalADC.startReading();     // start the ADC going.
-}
-
-void stopReadings (void)
-{
-  // Stop the ADC.
-  InternalADC.noInterruptOnDone();
-  InternalADC.singleReadingMode();
-}
-
-// "Decimate" the accumulated reading and process the result
-void processReading(void)
+// Process the 12-bit result
+void processReading(long r12bit)
 {
-  int r12bit = (readSum + 8) >> 2;
-  // r12bit has a value between 0 and 4094.
+  // r12bit has a value between 0 and 4092.
 
   // Do something with the value.
   // Here we'll just print it and the voltage  to the Arduino Serial Monitor.
   Serial.print("12 bit reading value: ");
   Serial.println(r12bit);
 
-  float volts = ((float)r12bit * REFERENCE_VOLTS) / 4094.0;
+  float volts = ((float)r12bit * REFERENCE_VOLTS) / 4096.0;
   Serial.print("Voltage: ");
   Serial.println(volts, 4);
 }
@@ -131,61 +87,55 @@ void setup()
 {
   Serial.begin(9600);
 
-  // Start a source of electrical noise as above.
-  tone(TONE_PIN, 579);
-  delay(1000); // wait for tone signal to stabilise
-
-
-  // InternalADC.powerOn();
-  // InternalADC.singleReadingMode();
-  // InternalADC.bitDepth10();
-  // InternalADC.speed1x();
-  // InternalADC.referenceDefault();
-  // InternalADC.noInterruptOnDone();
-
   InternalADC.begin();
-  // begin() does the above six things and connects the ADC's input to internal ground.
+  // begin() powers on the ADC, sets 10 bit depth, speed1x(), the default
+  // reference, single reading mode, and connects the ADC's input to internal
+  // ground.
 
-  InternalADC.speed2x();
-  InternalADC.attachDoneInterruptFunction(accumulateReadingsISR);
+  InternalADC.bitDepth12();     // 16 readings per result, 125 kHz ADC clock.
   InternalADC.usePin(ANALOG_PIN);
 
+  // Start the source of electrical noise as above. Do this after
+  // bitDepth12(): the frequency depends on the bit depth.
+  InternalADC.ditherOn();
+  delay(1000); // wait for dither signal to stabilise
 }
 
 void loop()
 {
   static bool wantReading = true;
+  static bool waitingForADC = false;
   static unsigned long nextReadingTime;
 
   // Limit output on the serial monitor to 5 cycles
   static short numCyclesToPrint = 5;
-  if (numCyclesToPrint == 0)
+  if (wantReading && numCyclesToPrint == 0)
   {
     // We have finished the example.
     // Stop the noise generator.
-    noTone(TONE_PIN);
+    InternalADC.ditherOff();
 
     wantReading = false;
     InternalADC.powerOff();
   }
 
   // Process completed reading accumulation
-  if (wantReading && readingDone)
+  if (waitingForADC && InternalADC.oversampledReady())
   {
-    stopReadings(); // stop the hardware calling the accumulate ISR
-    // because we have finished accumulating the 16 10-bit readings
+    waitingForADC = false;
     nextReadingTime = millis() + READING_INTERVAL_MILLIS;
-    processReading();
+    processReading(InternalADC.getOversampledReading());
     numCyclesToPrint--;
   }
 
   // Start a 12-bit reading if it is time
-  if (wantReading && millis() >= nextReadingTime)
+  if (wantReading && !waitingForADC && millis() >= nextReadingTime)
   {
-    readingDone = false;  // set to true by the ISR.
-    startReadings();
-    // Readings take place in the background but still take
-    // 16 x 54 = 864 microseconds, plus overhead.
+    InternalADC.startOversampledReading();
+    waitingForADC = true;
+    // The 16 readings are added up in the background by the ADC's
+    // "conversion complete" interrupt: 16 x 104 = 1664 microseconds.
+    // (Or, blocking: long r12bit = InternalADC.readOversampled();)
   }
 
   /*
@@ -202,4 +152,4 @@ void loop()
   */
   delay(167);
 
-}
\ No newline at end of file
+}
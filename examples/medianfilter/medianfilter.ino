@@ -1,4 +1,5 @@
 #include <Arduino.h>
+#include "AnalogControlPanel.h"
 /* 
   Median filter: smooth data by selecting middle value of 3 neighboring values.
 
@@ -13,7 +14,12 @@
   This just demonstrates the technique. It should be possible to optimise the code
   and to vary it for your application.
 
-  This example does not depend on Analog Control Panel functions.
+  The first part does not depend on Analog Control Panel functions: it filters
+  a whole array after the readings are taken.
+
+  The second part uses the library's streaming ACPMedianFilter, which filters
+  each reading as it arrives and needs no second array. It can also be run in
+  the ADC's "conversion complete" interrupt: InternalADC.streamInto(buffer, filter).
 
    GvP-257 2025-09.  Public domain.
 */
@@ -96,6 +102,14 @@ void setup()
 	Serial.print(F("Filtered data:"));
 	printArray(filteredData, len);
 
+	// Streaming: one reading in, one filtered reading out.
+	// The output is one reading behind: the median of three needs the
+	// reading after, too.
+	ACPMedianFilter<3> despike;
+	for (size_t i = 0; i < len; i++) {filteredData[i] = despike.feed(data[i]);}
+	Serial.print(F("Streamed:     "));
+	printArray(filteredData, len);
+
 	Serial.println(F(" ------- End of medianfilter example -------"));
 	Serial.flush();
 	exit(0);
@@ -103,6 +117,7 @@ void setup()
 	// Results:-
 	// Original data:127	134	  6	    135	  134	  135	  1003	 137 	 126	  17.
 	// Filtered data:127	127	  134	  134	  135	  135	  137	   137	 126	  126.
+	// Streamed:     127	127	  127	  134	  134	  135	  135	   137	 137	  126.
 	// ------- End of medianfilter example -------
 
 }
@@ -6,7 +6,10 @@
 
 #include "AnalogControlPanel.h"
 
-#define  INTERNAL_REF_V  1.100F  // 1.100V, change this value if known
+// To calibrate: measure the Arduino's supply (5V pin) with a multimeter, put
+// the reading here in millivolts, upload once. Then set it back to 0 and
+// upload again: the calibration stays in EEPROM.
+#define  METER_SUPPLY_MV  0
 
 
 void setup()
@@ -14,21 +17,24 @@ void setup()
     // InternalADC.powerOn(); // Necessary to set up AREF and clock
     // InternalADC.rate9k();
     InternalADC.begin();      // Combined power on, set rate and reference.
-
+                              // Also loads the calibration, if any.
     Serial.begin();   // default baud rate 9600.
 
-    InternalADC.setInternalReferenceVoltage(INTERNAL_REF_V);
+    if (METER_SUPPLY_MV)
+    {
+        Serial.print("Calibrating against ");
+        Serial.print(METER_SUPPLY_MV);
+        Serial.println(" mV.");
+        InternalADC.calibrateBandgap(METER_SUPPLY_MV);
+    }
     Serial.print(" Using internal reference voltage ");
-    Serial.println(INTERNAL_REF_V);
+    Serial.print(InternalADC.internalReferenceMillivolts());
+    Serial.println(" mV");
     Serial.println();
 
     Serial.print("Estimated Arduino supply voltage: ");
-
-    // Read several times to settle down the internal voltage reference.
-    for (short i = 0; i < 7; i++) {InternalADC.getSupplyVoltage();}
-
-    //Now print a reading.
-    Serial.println(InternalADC.getSupplyVoltage());
+    Serial.print(InternalADC.getSupplyMillivolts());
+    Serial.println(" mV");
 
     Serial.flush();
 }
@@ -36,4 +42,4 @@ void setup()
 void loop()
 {
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,88 @@
+// GvP 2025-10.
+// https://github.com/gvp-257/analogcontrolpanel
+
+/*
+ * Unpack blocks written out from ACPPacked10 / ACPPackedDelta buffers
+ * (src/ACP_PackedBuffer.h) on a PC: one reading per line.
+ *
+ *   acpdecode 10bit [count] < block.bin > readings.txt
+ *   acpdecode delta         < block.bin > readings.txt
+ *
+ * 10bit: without count, every reading of every five-byte group, so a
+ * part-filled last group gives up to three extra readings: pass count()
+ * to drop them. Each delta block starts again from zero, as the buffer does
+ * after clear(): decode blocks one file at a time.
+ *
+ * Standard C++ only, no library headers:
+ *   g++ -O2 -o acpdecode extras/decode/ACPDecode.cpp
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+static int usage(void)
+{
+    fprintf(stderr, "usage: acpdecode 10bit [count] < block.bin\n"
+                    "       acpdecode delta < block.bin\n");
+    return 2;
+}
+
+// Four readings from each five bytes; top bits in the fifth.
+static unsigned long decode10(FILE * in, unsigned long count)
+{
+    unsigned char g[5];
+    unsigned long n = 0;
+    size_t got;
+    while (n < count && (got = fread(g, 1, 5, in)) > 0)
+    {
+        if (got < 5)
+        {
+            fprintf(stderr, "acpdecode: %u stray bytes at the end\n", (unsigned)got);
+            break;
+        }
+        for (int k = 0; k < 4 && n < count; k++, n++)
+            printf("%u\n", g[k] | (((g[4] >> (2 * k)) & 0x03) << 8));
+    }
+    return n;
+}
+
+// Zig-zag varint differences from the previous reading, starting at 0.
+static unsigned long decodeDelta(FILE * in)
+{
+    uint16_t last = 0;
+    unsigned long n = 0;
+    int c;
+    while ((c = getc(in)) != EOF)
+    {
+        uint16_t z = c & 0x7f;
+        if (c & 0x80)
+        {
+            int c2 = getc(in);
+            if (c2 == EOF)
+            {
+                fprintf(stderr, "acpdecode: block ends halfway through a reading\n");
+                break;
+            }
+            z |= (uint16_t)c2 << 7;
+        }
+        last += (uint16_t)((z >> 1) ^ -(z & 1));
+        printf("%u\n", last);
+        n++;
+    }
+    return n;
+}
+
+int main(int argc, char ** argv)
+{
+    if (argc < 2) return usage();
+    unsigned long n;
+    if (strcmp(argv[1], "10bit") == 0 && argc <= 3)
+        n = decode10(stdin, argc == 3 ? strtoul(argv[2], 0, 10) : (unsigned long)-1);
+    else if (strcmp(argv[1], "delta") == 0 && argc == 2)
+        n = decodeDelta(stdin);
+    else return usage();
+    fprintf(stderr, "acpdecode: %lu readings\n", n);
+    return 0;
+}
@@ -0,0 +1,144 @@
+// GvP 2025-10.
+// https://github.com/gvp-257/analogcontrolpanel
+
+/*
+ * Check acpdecode against the library's own packed buffers: fill
+ * ACPPacked10 and ACPPackedDelta blocks with known readings on the host
+ * model (extras/host), write out data() and bytes() as a logger would,
+ * decode them with acpdecode, and compare reading for reading. Also checks
+ * that next() gives back the same readings. Exit status 0: all match.
+ *
+ * Built and run by extras/decode/test.sh.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "AnalogControlPanel.h"
+
+static const char * decoder = "./acpdecode";
+static int failures = 0;
+
+// Decode bytes with acpdecode (mode "10bit N" or "delta") and compare with
+// the readings expected.
+template <typename BUFFER>
+static void check(const char * name, BUFFER & block, const char * mode,
+                  const uint16_t * expected, const uint16_t n)
+{
+    const char * file = "acpdecode-test.bin";
+    FILE * out = fopen(file, "wb");
+    if (!out) {perror(file); exit(2);}
+    fwrite(block.data(), 1, block.bytes(), out);
+    fclose(out);
+
+    char command[128];
+    snprintf(command, sizeof command, "%s %s < %s 2>/dev/null", decoder, mode, file);
+    FILE * in = popen(command, "r");
+    if (!in) {perror(command); exit(2);}
+    unsigned got = 0, value;
+    bool same = true;
+    while (fscanf(in, "%u", &value) == 1)
+    {
+        if (got >= n || value != expected[got])
+        {
+            if (same)
+                printf("%s: reading %u is %u, expected %u\n", name, got, value,
+                       got < n ? expected[got] : 0);
+            same = false;
+        }
+        got++;
+    }
+    pclose(in);
+    remove(file);
+    if (got != n)
+    {
+        printf("%s: %u readings decoded, expected %u\n", name, got, n);
+        same = false;
+    }
+
+    uint16_t r, k = 0;
+    block.rewind();
+    while (block.next(r))
+    {
+        if (k >= n || r != expected[k])
+        {
+            printf("%s: next() reading %u is %u\n", name, k, r);
+            same = false;
+            break;
+        }
+        k++;
+    }
+    if (k != n && same) {printf("%s: next() gave %u readings\n", name, k); same = false;}
+
+    printf("%-36s %4u readings, %4u bytes: %s\n", name, n, block.bytes(),
+           same ? "ok" : "FAILED");
+    if (!same) failures++;
+}
+
+// Push readings until the block is full; returns how many went in.
+template <typename BUFFER>
+static uint16_t fill(BUFFER & block, const uint16_t * readings, const uint16_t n)
+{
+    block.clear();
+    uint16_t i = 0;
+    while (i < n && block.push(readings[i])) i++;
+    return i;
+}
+
+int main(int argc, char ** argv)
+{
+    if (argc > 1) decoder = argv[1];
+    static uint16_t r[2000];
+    char mode[16];
+
+    // 10-bit: every value 0..1023 turns up, part-filled last groups of
+    // one to three readings, and a block filled to the last byte.
+    for (uint16_t i = 0; i < 1100; i++) r[i] = (i * 397u + 5) & 0x3ff;
+    r[0] = 0; r[1] = 1023; r[2] = 512; r[3] = 511;
+    {
+        ACPPacked10<1375> block;                    // 1100 readings exactly
+        uint16_t n = fill(block, r, 1100);
+        snprintf(mode, sizeof mode, "10bit %u", n);
+        check("10bit, full block", block, mode, r, n);
+        if (n != 1100 || !block.full() || block.push(0))
+            {printf("10bit: full block took %u readings\n", n); failures++;}
+    }
+    for (uint16_t tail = 1; tail <= 3; tail++)
+    {
+        ACPPacked10<500> block;
+        uint16_t n = fill(block, r, 36 + tail);
+        snprintf(mode, sizeof mode, "10bit %u", n);
+        char name[40];
+        snprintf(name, sizeof name, "10bit, %u in the last group", tail);
+        check(name, block, mode, r, n);
+    }
+
+    // Delta: small steps both ways, the -64 and +63 edges of one-byte
+    // codes and one past them, the biggest jumps (0 <-> 1023, where the
+    // 16-bit difference wraps round), and a slow ramp.
+    uint16_t n = 0, v = 500;
+    r[n++] = v;                                     // from 0: a two-byte code
+    static const int16_t steps[] = {0, 1, -1, 2, -2, 63, -64, 64, -65, -1,
+                                    100, -300, 7, -7};
+    for (uint8_t i = 0; i < sizeof steps / sizeof steps[0]; i++)
+        {v += steps[i]; r[n++] = v;}
+    r[n++] = 1023; r[n++] = 0; r[n++] = 1023; r[n++] = 0; r[n++] = 0;
+    for (uint16_t i = 0; i < 300; i++) r[n++] = 200 + (i % 40 < 20 ? i % 40 : 40 - i % 40);
+    for (uint16_t i = 0; i < 200; i++) r[n++] = (i * 131u) & 0x3ff;
+    {
+        ACPPackedDelta<2000> block;
+        uint16_t got = fill(block, r, n);
+        if (got != n) {printf("delta: only %u of %u readings fitted\n", got, n); failures++;}
+        check("delta, steps, jumps and wraps", block, "delta", r, got);
+    }
+    {
+        ACPPackedDelta<64> block;                   // fills up: overruns
+        uint16_t got = fill(block, r, n);
+        check("delta, full block", block, "delta", r, got);
+        if (!block.full() || block.overruns() == 0)
+            {printf("delta: full block not full\n"); failures++;}
+    }
+
+    if (failures) printf("%d FAILED\n", failures);
+    else          printf("All match.\n");
+    return failures ? 1 : 0;
+}
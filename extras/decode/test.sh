@@ -0,0 +1,20 @@
+#!/bin/sh
+# GvP 2025-10.
+# Build acpdecode and check it against the library's own ACPPacked10 and
+# ACPPackedDelta buffers, filled on the host model (extras/host). Exit
+# status 1 if any reading differs.
+#
+#   extras/decode/test.sh
+
+set -e
+here=$(cd "$(dirname "$0")" && pwd)
+lib="$here/../.."
+build=${TMPDIR:-/tmp}/acpdecode-test
+
+mkdir -p "$build"
+g++ -O2 -o "$build/acpdecode" "$here/ACPDecode.cpp"
+g++ -std=gnu++11 -DF_CPU=16000000UL -D__AVR_ATmega328P__ \
+    -I "$lib/extras/host/include" -I "$lib/src" -o "$build/decodetest" \
+    "$here/ACPDecodeTest.cpp" "$lib/src/AnalogControlPanel_M328P.cpp" \
+    "$lib/extras/host/ACP_HostModel.cpp"
+cd "$build" && ./decodetest ./acpdecode
@@ -0,0 +1,216 @@
+// GvP 2025-10.
+// https://github.com/gvp-257/analogcontrolpanel
+
+/*
+ * Regression checks on the host model: the library's read, sampling,
+ * scanning and stop paths driven the way a sketch would, one line of
+ * results per check. test.sh compares the lines with regression.txt, so a
+ * change that alters a reading, a count or a timing shows up as a
+ * difference. No noise: every run gives the same numbers.
+ *
+ * Each check leaves the ADC as a sketch would find it after the call, and
+ * the next one carries on from there: stray conversions and flags left
+ * behind by one path show up in the next one's readings.
+ */
+
+#include <stdio.h>
+
+// As Arduino.h has them, ahead of a sketch's #include of the library.
+#define DEFAULT  1
+#define INTERNAL 3
+#define EXTERNAL 0
+
+#include "AnalogControlPanel.h"
+#include "ACP_Host.h"
+
+#define A0_PIN 14
+#define A1_PIN 15
+#define A2_PIN 16
+#define A3_PIN 17
+
+// Timer0 as the Arduino core sets it up: fast PWM, clock / 64. The overflow
+// interrupt only has to be there.
+extern "C" void TIMER0_OVF_vect(void) {}
+
+static void line(const char * name) {printf("%-30s", name);}
+static bool interruptsOn(void) {return SREG & (1<<SREG_I);}
+
+int main()
+{
+    ACPHost::reset();
+    ACPHost::setPinVoltage(0, 1.25);
+    ACPHost::setPinVoltage(1, 2.50);
+    ACPHost::setPinVoltage(2, 0.50);
+    ACPHost::setPinVoltage(3, 0.80);
+    TCCR0A = (1<<WGM01) | (1<<WGM00); TCCR0B = 3;
+
+    InternalADC.begin();
+
+    line("analogRead A0 A1 A2");
+    int a0 = InternalADC.analogRead(A0_PIN);
+    int a1 = InternalADC.analogRead(A1_PIN);
+    int a2 = InternalADC.analogRead(A2_PIN);
+    printf("%d %d %d\n", a0, a1, a2);
+
+    InternalADC.usePin(A3_PIN);
+    line("read read8Bit");
+    int r10 = InternalADC.read();
+    int r8 = InternalADC.read8Bit();
+    printf("%d %d\n", r10, r8);
+
+    line("sleepRead, interrupts on");
+    int rs = InternalADC.sleepRead();
+    printf("%d %d\n", rs, interruptsOn());
+
+    line("sleepReadAverage(8)");
+    printf("%d\n", InternalADC.sleepReadAverage(8));
+
+    int burst[8];
+    line("readBurst(8), period");
+    unsigned long period = InternalADC.readBurst(burst, 8);
+    printf("%d %d %lu\n", burst[0], burst[7], period);
+
+    line("speed4x read");
+    InternalADC.speed4x();
+    printf("%d\n", InternalADC.read());
+    InternalADC.speed1x();
+
+    // Sampling at 1 kHz into a ring buffer while loop() is busy.
+    ACPRingBuffer16<32> ring;
+    ACPHost::clearStats();
+    line("sampleAt(1000) rate");
+    printf("%lu\n", InternalADC.sampleAt(1000));
+    InternalADC.streamInto(ring);
+    ACPHost::runMicros(20000);
+    line("sampled: count first conv");
+    unsigned count = ring.count();
+    printf("%u %u %lu\n", count, ring.pop(),
+           (unsigned long)ACPHost::stats().conversions);
+    InternalADC.stopStreaming();
+    InternalADC.stopSampling();
+
+    // Stopped part way through a triggered conversion: the internal reads
+    // after must not pick up the one under way, or start a stray one.
+    InternalADC.usePin(A0_PIN);
+    InternalADC.sampleAt(1000);
+    ACPHost::runMicros(5030);
+    InternalADC.stopSampling();
+    line("after stopSampling: mV temp");
+    unsigned mV = InternalADC.getSupplyMillivolts();
+    int t = InternalADC.readTempSensor();
+    printf("%u %d\n", mV, t);
+
+    // A conversion running on entry to each internal read.
+    line("conversion under way: mV T T");
+    InternalADC.startReading(); ACPHost::run(20);
+    mV = InternalADC.getSupplyMillivolts();
+    int t1 = InternalADC.readTempSensor();
+    InternalADC.startReading(); ACPHost::run(20);
+    int cC = InternalADC.getTemperatureCentiC();
+    int t2 = InternalADC.readTempSensor();
+    printf("%u %d %d %d\n", mV, t1, cC, t2);
+
+    // Free running, polled.
+    InternalADC.usePin(A1_PIN);
+    InternalADC.freeRunningMode();
+    InternalADC.startReading();
+    ACPHost::runMicros(500);
+    line("free running getLastReading");
+    printf("%d\n", InternalADC.getLastReading());
+    InternalADC.singleReadingMode();
+    loop_until_bit_is_clear(ADCSRA, ADSC);
+    line("after free running: read");
+    InternalADC.usePin(A2_PIN);
+    printf("%d\n", InternalADC.read());
+
+    // Scanning four pins.
+    static const uint8_t pins[4] = {A0_PIN, A1_PIN, A2_PIN, A3_PIN};
+    static volatile int results[4];
+    InternalADC.scanPins(pins, 4, results);
+    InternalADC.startScan();
+    ACPHost::runMicros(5000);
+    line("scan: readings, sweeps");
+    printf("%d %d %d %d %u\n", InternalADC.scanReading(0), InternalADC.scanReading(1),
+           InternalADC.scanReading(2), InternalADC.scanReading(3), InternalADC.scanSweeps());
+    InternalADC.stopScan();
+    line("after stopScan: temp ADIE");
+    t = InternalADC.readTempSensor();
+    printf("%d %d\n", t, (ADCSRA & (1<<ADIE)) != 0);
+
+    // Channels with their own references, and the same with Arduino's
+    // names for them.
+    static const ACPChannel channels[3] = {
+        {A0_PIN, ACP_REF_AVCC,     10, 125000UL, 0},
+        {A3_PIN, ACP_REF_INTERNAL, 10, 125000UL, 0},
+        {A2_PIN, ACP_REF_AVCC,      8, 250000UL, 0}};
+    static const ACPChannel arduinoRefs[3] = {
+        {A0_PIN, DEFAULT,  10, 125000UL, 0},
+        {A3_PIN, INTERNAL, 10, 125000UL, 0},
+        {A2_PIN, DEFAULT,   8, 250000UL, 0}};
+    static volatile int chResults[3];
+    InternalADC.channelList(arduinoRefs, 3, chResults);
+    InternalADC.readChannels();
+    line("readChannels, Arduino's refs");
+    printf("%d %d %d\n", InternalADC.channelReading(0), InternalADC.channelReading(1),
+           InternalADC.channelReading(2));
+    InternalADC.usePin(A1_PIN);
+    InternalADC.channelList(channels, 3, chResults);
+    InternalADC.readChannels();
+    line("readChannels");
+    printf("%d %d %d\n", InternalADC.channelReading(0), InternalADC.channelReading(1),
+           InternalADC.channelReading(2));
+    line("after readChannels: read A1");
+    printf("%d %d\n", InternalADC.read(), DIDR0 == (1<<1));
+    InternalADC.startChannels();
+    ACPHost::runMicros(3000);
+    InternalADC.stopChannels();
+    line("after stopChannels: read A0");
+    InternalADC.usePin(A0_PIN);
+    InternalADC.referenceDefault();
+    printf("%d\n", InternalADC.read());
+
+    // Oversampled.
+    InternalADC.bitDepth12();
+    line("readOversampled 12-bit A0");
+    printf("%ld\n", InternalADC.readOversampled());
+    InternalADC.bitDepth10();
+    line("readOversampled, no bit depth");
+    printf("%ld\n", InternalADC.readOversampled());
+
+    // Internal reference with Timer0 in CTC, TOP below the settling count:
+    // must not hang.
+    TCCR0A = (1<<WGM01); OCR0A = 100; TCCR0B = 2; TCNT0 = 0;
+    line("CTC Timer0: internal ref read");
+    InternalADC.usePin(A3_PIN);
+    InternalADC.referenceInternal();
+    printf("%d\n", InternalADC.read());
+    InternalADC.referenceDefault();
+    TCCR0A = (1<<WGM01) | (1<<WGM00); TCCR0B = 3;
+
+    // Woken by a power session on the internal reference: the bandgap was
+    // off with the ADC, and has to settle again.
+    InternalADC.usePin(A3_PIN);
+    InternalADC.referenceInternal();
+    InternalADC.speed4x();
+    InternalADC.read();
+    InternalADC.powerOff();
+    ACPHost::runMicros(1000);
+    line("session after park: int ref");
+    {
+        ACPPowerSession on;
+        printf("%d\n", InternalADC.read());
+    }
+    InternalADC.powerOn();
+
+    // ACPConfigChange's references, with Arduino's names: REFS bits only.
+    line("ACPConfigChange REFS: D I E");
+    ACPConfigChange change;
+    change.reference(DEFAULT);  int rD = change.settings().admux >> 6;
+    change.reference(INTERNAL); int rI = change.settings().admux >> 6;
+    change.reference(EXTERNAL); int rE = change.settings().admux >> 6;
+    printf("%d %d %d\n", rD, rI, rE);
+
+    line("interrupts on at the end");
+    printf("%d\n", interruptsOn());
+    return 0;
+}
@@ -0,0 +1,590 @@
+// GvP 2025-10.
+// https://github.com/gvp-257/analogcontrolpanel
+
+// Behavioural model of the ATmega328P's ADC, Timer0, Timer1 and interrupt
+// logic, for building and running the library on a PC. See ACP_Host.h for
+// what is modelled, and Readme.md for how to build.
+
+#include <math.h>
+#include <avr/io.h>
+#include <avr/sleep.h>
+#include <avr/eeprom.h>
+#include "ACP_Host.h"
+
+// Interrupt handlers the library or the program under test may define.
+extern "C"
+{
+    void INT0_vect(void)         __attribute__((weak));
+    void TIMER1_CAPT_vect(void)  __attribute__((weak));
+    void TIMER1_COMPA_vect(void) __attribute__((weak));
+    void TIMER1_COMPB_vect(void) __attribute__((weak));
+    void TIMER1_OVF_vect(void)   __attribute__((weak));
+    void TIMER0_OVF_vect(void)   __attribute__((weak));
+    void ADC_vect(void)          __attribute__((weak));
+}
+
+// The register objects.
+ACPHostReg8  ADMUX  = {ACP_REG_ADMUX},  ADCSRA = {ACP_REG_ADCSRA},
+             ADCSRB = {ACP_REG_ADCSRB}, ADCL   = {ACP_REG_ADCL},
+             ADCH   = {ACP_REG_ADCH},   DIDR0  = {ACP_REG_DIDR0},
+             PRR    = {ACP_REG_PRR},    SREG   = {ACP_REG_SREG},
+             SMCR   = {ACP_REG_SMCR},   MCUCR  = {ACP_REG_MCUCR},
+             TCCR0A = {ACP_REG_TCCR0A}, TCCR0B = {ACP_REG_TCCR0B},
+             TCNT0  = {ACP_REG_TCNT0},  OCR0A  = {ACP_REG_OCR0A},
+             OCR0B  = {ACP_REG_OCR0B},  TIMSK0 = {ACP_REG_TIMSK0},
+             TIFR0  = {ACP_REG_TIFR0},
+             TCCR1A = {ACP_REG_TCCR1A}, TCCR1B = {ACP_REG_TCCR1B},
+             TCCR1C = {ACP_REG_TCCR1C}, TIMSK1 = {ACP_REG_TIMSK1},
+             TIFR1  = {ACP_REG_TIFR1},
+             TCCR2A = {ACP_REG_TCCR2A}, TCCR2B = {ACP_REG_TCCR2B},
+             TCNT2  = {ACP_REG_TCNT2},  OCR2A  = {ACP_REG_OCR2A},
+             OCR2B  = {ACP_REG_OCR2B},  TIMSK2 = {ACP_REG_TIMSK2},
+             TIFR2  = {ACP_REG_TIFR2},  ASSR   = {ACP_REG_ASSR},
+             GTCCR  = {ACP_REG_GTCCR},  EIFR   = {ACP_REG_EIFR},
+             EIMSK  = {ACP_REG_EIMSK},  EICRA  = {ACP_REG_EICRA},
+             ACSR   = {ACP_REG_ACSR},
+             DDRB   = {ACP_REG_DDRB},   PORTB  = {ACP_REG_PORTB},
+             PINB   = {ACP_REG_PINB},   DDRC   = {ACP_REG_DDRC},
+             PORTC  = {ACP_REG_PORTC},  PINC   = {ACP_REG_PINC},
+             DDRD   = {ACP_REG_DDRD},   PORTD  = {ACP_REG_PORTD},
+             PIND   = {ACP_REG_PIND};
+ACPHostReg16 ADC    = {ACP_REG_ADC},    TCNT1  = {ACP_REG_TCNT1},
+             OCR1A  = {ACP_REG_OCR1A},  OCR1B  = {ACP_REG_OCR1B},
+             ICR1   = {ACP_REG_ICR1};
+
+
+//------------------------------------------------------------------------------
+// State
+
+static const uint64_t NEVER = ~(uint64_t)0;
+
+static uint16_t reg[ACP_REG_COUNT];  // register contents, where stored as is
+static uint64_t now;                 // CPU cycles since reset()
+static bool     iflag;               // SREG I bit
+static bool     inISR;
+static uint64_t iOffSince;
+static uint32_t handlersRun;
+
+// ADC
+static bool     converting;
+static uint64_t convEnd;
+static double   convSampleAt;        // cycles
+static uint8_t  convMux;
+static bool     firstConversion;
+static uint16_t adcData;             // 10-bit result
+static bool     adcWasOn;
+static bool     bgWasOn;             // bandgap: on with the ADC or ACBG
+static uint64_t bgOnSince;
+
+// Reference node: relaxes towards the selected reference.
+static uint8_t  refSel;
+static double   refFrom;
+static uint64_t refSwitchedAt;
+
+// Timers
+static uint16_t t0Count;
+static uint64_t t0Stamp;
+static uint16_t t1Count;
+static uint64_t t1Stamp;
+
+// Signals
+static double   pinVolts[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+static double (*pinSignal[8])(double) = {0, 0, 0, 0, 0, 0, 0, 0};
+static double   avcc = 5.0, aref = 5.0, vbg = 1.1, tempC = 25.0;
+static double   noiseLsb = 0;
+static uint32_t rng = 1;
+static const double BANDGAP_STARTUP = 70e-6;    // seconds
+static const double REF_SETTLE_TAU  = 10e-6;
+
+static ACPHost::Stats st;
+
+uint8_t acp_host_eeprom[E2END + 1];   // inverted: see <avr/eeprom.h>
+
+
+//------------------------------------------------------------------------------
+// ADC
+
+static bool adcOn(void)
+{
+    return (reg[ACP_REG_ADCSRA] & _BV(ADEN)) && !(reg[ACP_REG_PRR] & _BV(PRADC));
+}
+
+static uint32_t adcDiv(void)
+{
+    uint8_t ps = reg[ACP_REG_ADCSRA] & 0x07;
+    return ps ? (1UL << ps) : 2;
+}
+
+static double bandgapAt(const double t)
+{
+    double up = (t - (double)bgOnSince) / F_CPU;
+    if (!bgWasOn || up < 0) return 0;
+    if (up >= BANDGAP_STARTUP) return vbg;
+    return vbg * up / BANDGAP_STARTUP;
+}
+
+static double refTarget(const uint8_t sel, const double t)
+{
+    switch (sel)
+    {
+        case 0:  return aref;
+        case 3:  return bandgapAt(t);
+        default: return avcc;
+    }
+}
+
+static double refAt(const double t)
+{
+    double target = refTarget(refSel, t);
+    double dt = (t - (double)refSwitchedAt) / F_CPU;
+    if (dt < 0) dt = 0;
+    return target + (refFrom - target) * exp(-dt / REF_SETTLE_TAU);
+}
+
+static void selectReference(const uint8_t sel)
+{
+    if (sel == refSel) return;
+    refFrom = refAt((double)now);
+    refSel = sel;
+    refSwitchedAt = now;
+}
+
+static double inputAt(const uint8_t mux, const double t)
+{
+    if (mux < 8)
+    {
+        if (pinSignal[mux]) return pinSignal[mux](t / F_CPU);
+        return pinVolts[mux];
+    }
+    if (mux == 8)  return 0.314 + (tempC - 25.0) * 0.001;  // ~1 mV per degree
+    if (mux == 14) return bandgapAt(t);
+    return 0;                                               // 15 = ground
+}
+
+static double gaussian(void)
+{
+    // xorshift32 and Box-Muller: repeatable noise.
+    rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+    double u1 = (rng + 1.0) / 4294967297.0;
+    rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+    double u2 = (rng + 1.0) / 4294967297.0;
+    return sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+}
+
+static uint16_t convert(void)
+{
+    double vref = refAt(convSampleAt);
+    if (vref <= 0) return 1023;
+    double code = inputAt(convMux, convSampleAt) * 1024.0 / vref;
+    if (noiseLsb > 0) code += noiseLsb * gaussian();
+    if (code < 0)    return 0;
+    if (code > 1023) return 1023;
+    return (uint16_t)code;
+}
+
+// Start a conversion on the next ADC clock edge. An auto trigger resets the
+// prescaler, and free running carries straight on, so those start now.
+static void startConversion(const bool autoTriggered, const bool freeRunning)
+{
+    if (!adcOn() || converting) return;
+    uint64_t div   = adcDiv();
+    uint64_t start = autoTriggered ? now : ((now + div - 1) / div) * div;
+    uint32_t halfClocks = firstConversion ? 50 : 26;
+    if (autoTriggered && !freeRunning && !firstConversion) halfClocks += 1;
+    convEnd      = start + halfClocks * div / 2;
+    convSampleAt = (double)start + (firstConversion ? 13.5 : 1.5) * div;
+    convMux      = reg[ACP_REG_ADMUX] & 0x0f;
+    firstConversion = false;
+    converting   = true;
+    st.conversions++;
+}
+
+static void adcTrigger(const uint8_t source)
+{
+    if (!adcOn() || !(reg[ACP_REG_ADCSRA] & _BV(ADATE))) return;
+    if ((reg[ACP_REG_ADCSRB] & 0x07) != source) return;
+    if (converting) {st.triggersLost++; return;}
+    startConversion(true, false);
+}
+
+// Set an interrupt flag; a rising flag can trigger the ADC.
+static void setFlag(const uint8_t r, const uint8_t bit, const int adcSource)
+{
+    if (reg[r] & _BV(bit)) return;
+    reg[r] |= _BV(bit);
+    if (adcSource >= 0) adcTrigger((uint8_t)adcSource);
+}
+
+static void conversionDone(void)
+{
+    converting = false;
+    adcData = convert();
+    reg[ACP_REG_ADCSRA] |= _BV(ADIF);
+    if ((reg[ACP_REG_ADCSRA] & _BV(ADATE)) && (reg[ACP_REG_ADCSRB] & 0x07) == 0)
+        startConversion(true, true);
+}
+
+static void bandgapPowerChanged(void)
+{
+    bool on = adcOn() || (reg[ACP_REG_ACSR] & _BV(ACBG));
+    if (on && !bgWasOn) bgOnSince = now;
+    bgWasOn = on;
+}
+
+static void adcPowerChanged(void)
+{
+    bool on = adcOn();
+    if (on && !adcWasOn) firstConversion = true;
+    if (!on) converting = false;
+    adcWasOn = on;
+    bandgapPowerChanged();
+}
+
+
+//------------------------------------------------------------------------------
+// Timers
+
+static const uint16_t t0Prescale[8] = {0, 1, 8, 64, 256, 1024, 0, 0};
+static const uint16_t t1Prescale[8] = {0, 1, 8, 64, 256, 1024, 0, 0};
+
+static uint16_t t0Top(void)
+{
+    uint8_t mode = (reg[ACP_REG_TCCR0A] & 0x03) | ((reg[ACP_REG_TCCR0B] >> 1) & 0x04);
+    return (mode == 2) ? reg[ACP_REG_OCR0A] : 0xff;
+}
+
+static uint8_t t1Mode(void)
+{
+    return (reg[ACP_REG_TCCR1A] & 0x03) | ((reg[ACP_REG_TCCR1B] >> 1) & 0x0c);
+}
+
+static uint16_t t1Top(void)
+{
+    uint8_t mode = t1Mode();
+    if (mode == 4)  return reg[ACP_REG_OCR1A];
+    if (mode == 12) return reg[ACP_REG_ICR1];
+    return 0xffff;   // normal mode (PWM modes not modelled)
+}
+
+// Ticks until a counter at 'count' next reaches 'value'.
+static uint32_t ticksUntil(const uint16_t count, const uint16_t value,
+                           const uint16_t top, const uint32_t max)
+{
+    uint32_t wrap = (count <= top) ? (uint32_t)top + 1 : max;
+    if (value > count) return value - count;
+    return wrap - count + value;
+}
+
+static void advanceCount(uint16_t & count, const uint32_t ticks,
+                         const uint16_t top, const uint32_t max)
+{
+    uint32_t wrap = (count <= top) ? (uint32_t)top + 1 : max;
+    count = (uint16_t)(((uint32_t)count + ticks) % wrap);
+}
+
+static void t0Sync(void)
+{
+    uint16_t p = t0Prescale[reg[ACP_REG_TCCR0B] & 0x07];
+    if (!p) {t0Stamp = now; return;}
+    uint64_t ticks = (now - t0Stamp) / p;
+    t0Stamp += ticks * p;
+    advanceCount(t0Count, (uint32_t)ticks, t0Top(), 0x100);
+}
+
+static void t1Sync(void)
+{
+    uint16_t p = t1Prescale[reg[ACP_REG_TCCR1B] & 0x07];
+    if (!p) {t1Stamp = now; return;}
+    uint64_t ticks = (now - t1Stamp) / p;
+    t1Stamp += ticks * p;
+    advanceCount(t1Count, (uint32_t)ticks, t1Top(), 0x10000);
+}
+
+static uint64_t t0Next(void)
+{
+    uint16_t p = t0Prescale[reg[ACP_REG_TCCR0B] & 0x07];
+    if (!p || t0Top() != 0xff) return NEVER;
+    return t0Stamp + (uint64_t)ticksUntil(t0Count, 0, 0xff, 0x100) * p;
+}
+
+static uint64_t t1Next(void)
+{
+    uint16_t p = t1Prescale[reg[ACP_REG_TCCR1B] & 0x07];
+    if (!p) return NEVER;
+    uint16_t top = t1Top();
+    uint32_t d = ticksUntil(t1Count, reg[ACP_REG_OCR1A], top, 0x10000);
+    uint32_t e = ticksUntil(t1Count, reg[ACP_REG_OCR1B], top, 0x10000);
+    if (e < d) d = e;
+    if (top == 0xffff)
+    {
+        e = ticksUntil(t1Count, 0, top, 0x10000);
+        if (e < d) d = e;
+    }
+    return t1Stamp + (uint64_t)d * p;
+}
+
+static void t0Event(void)
+{
+    t0Sync();
+    if (t0Count == 0) setFlag(ACP_REG_TIFR0, TOV0, 4);
+}
+
+static void t1Event(void)
+{
+    t1Sync();
+    if (t1Count == reg[ACP_REG_OCR1A]) setFlag(ACP_REG_TIFR1, OCF1A, -1);
+    if (t1Count == reg[ACP_REG_OCR1B]) setFlag(ACP_REG_TIFR1, OCF1B, 5);
+    if (t1Mode() == 12 && t1Count == reg[ACP_REG_ICR1])
+        setFlag(ACP_REG_TIFR1, ICF1, 7);
+    if (t1Count == 0 && t1Top() == 0xffff) setFlag(ACP_REG_TIFR1, TOV1, 6);
+}
+
+
+//------------------------------------------------------------------------------
+// Interrupts and time
+
+static uint64_t nextEvent(void)
+{
+    uint64_t t = converting ? convEnd : NEVER;
+    uint64_t t0 = t0Next(), t1 = t1Next();
+    if (t0 < t) t = t0;
+    if (t1 < t) t = t1;
+    return t;
+}
+
+static void runVector(void (*vector)(void), const uint8_t flagReg, const uint8_t bit)
+{
+    reg[flagReg] &= ~_BV(bit);     // cleared as the handler starts
+    inISR = true;
+    iflag = false;
+    now += 7;                       // response time + jump
+    if (vector) vector();
+    now += 4;                       // reti
+    handlersRun++;
+    iflag = true;
+    inISR = false;
+}
+
+static void dispatch(void)
+{
+    while (iflag && !inISR)
+    {
+        // In priority order (vector number).
+        if ((reg[ACP_REG_EIFR] & _BV(INTF0)) && (reg[ACP_REG_EIMSK] & _BV(INT0)))
+            runVector(INT0_vect, ACP_REG_EIFR, INTF0);
+        else if ((reg[ACP_REG_TIFR1] & _BV(ICF1)) && (reg[ACP_REG_TIMSK1] & _BV(ICIE1)))
+            runVector(TIMER1_CAPT_vect, ACP_REG_TIFR1, ICF1);
+        else if ((reg[ACP_REG_TIFR1] & _BV(OCF1A)) && (reg[ACP_REG_TIMSK1] & _BV(OCIE1A)))
+            runVector(TIMER1_COMPA_vect, ACP_REG_TIFR1, OCF1A);
+        else if ((reg[ACP_REG_TIFR1] & _BV(OCF1B)) && (reg[ACP_REG_TIMSK1] & _BV(OCIE1B)))
+            runVector(TIMER1_COMPB_vect, ACP_REG_TIFR1, OCF1B);
+        else if ((reg[ACP_REG_TIFR1] & _BV(TOV1)) && (reg[ACP_REG_TIMSK1] & _BV(TOIE1)))
+            runVector(TIMER1_OVF_vect, ACP_REG_TIFR1, TOV1);
+        else if ((reg[ACP_REG_TIFR0] & _BV(TOV0)) && (reg[ACP_REG_TIMSK0] & _BV(TOIE0)))
+            runVector(TIMER0_OVF_vect, ACP_REG_TIFR0, TOV0);
+        else if ((reg[ACP_REG_ADCSRA] & _BV(ADIF)) && (reg[ACP_REG_ADCSRA] & _BV(ADIE)))
+        {
+            st.adcInterrupts++;
+            runVector(ADC_vect, ACP_REG_ADCSRA, ADIF);
+        }
+        else break;
+    }
+}
+
+static void advanceTo(uint64_t target)
+{
+    for (;;)
+    {
+        uint64_t t = nextEvent();
+        if (t > target) break;
+        if (t > now) now = t;
+        if (converting && convEnd <= now) conversionDone();
+        if (t0Next() <= now) t0Event();
+        if (t1Next() <= now) t1Event();
+        dispatch();
+        if (now > target) target = now;   // an interrupt handler took time
+    }
+    if (now < target) now = target;
+    dispatch();
+}
+
+static void tick(void) {advanceTo(now + 1);}
+
+
+//------------------------------------------------------------------------------
+// Register access
+
+uint16_t acp_host_read(const uint8_t r)
+{
+    tick();
+    st.registerReads++;
+    bool adlar = reg[ACP_REG_ADMUX] & _BV(ADLAR);
+    switch (r)
+    {
+        case ACP_REG_ADCSRA:
+            return (reg[r] & ~_BV(ADSC)) | (converting ? _BV(ADSC) : 0);
+        case ACP_REG_ADC:
+            return adlar ? (uint16_t)(adcData << 6) : adcData;
+        case ACP_REG_ADCL:
+            return adlar ? (uint8_t)(adcData << 6) : (uint8_t)adcData;
+        case ACP_REG_ADCH:
+            return adlar ? (uint8_t)(adcData >> 2) : (uint8_t)(adcData >> 8);
+        case ACP_REG_SREG:
+            return (reg[r] & 0x7f) | (iflag ? 0x80 : 0);
+        case ACP_REG_TCNT0:
+            t0Sync(); return t0Count;
+        case ACP_REG_TCNT1:
+            t1Sync(); return t1Count;
+        default:
+            return reg[r];
+    }
+}
+
+static void setI(const bool on)
+{
+    if (on == iflag) return;
+    if (!on)
+    {
+        if (!inISR) {st.interruptsOff++; iOffSince = now;}
+    }
+    else if (!inISR)
+    {
+        uint64_t len = now - iOffSince;
+        st.interruptsOffCycles += len;
+        if (len > st.longestInterruptsOff) st.longestInterruptsOff = (uint32_t)len;
+    }
+    iflag = on;
+}
+
+void acp_host_write(const uint8_t r, const uint16_t v)
+{
+    st.registerWrites++;
+    switch (r)
+    {
+        case ACP_REG_ADCSRA:
+        {
+            uint8_t flag = (v & _BV(ADIF)) ? 0 : (reg[r] & _BV(ADIF));
+            reg[r] = (v & ~(_BV(ADIF) | _BV(ADSC))) | flag;
+            adcPowerChanged();
+            if (v & _BV(ADSC)) startConversion(false, false);
+            break;
+        }
+        case ACP_REG_ADMUX:
+            reg[r] = v & 0xef;
+            selectReference((uint8_t)(v >> 6));
+            break;
+        case ACP_REG_PRR:
+            reg[r] = v;
+            adcPowerChanged();
+            break;
+        case ACP_REG_ACSR:
+            reg[r] = (v & ~_BV(ACI)) | (reg[r] & _BV(ACI) & ~v);
+            bandgapPowerChanged();
+            break;
+        case ACP_REG_ADC: case ACP_REG_ADCL: case ACP_REG_ADCH:
+            break;                                   // read only
+        case ACP_REG_TIFR0: case ACP_REG_TIFR1: case ACP_REG_TIFR2:
+        case ACP_REG_EIFR:
+            reg[r] &= ~v;                            // write 1 to clear
+            break;
+        case ACP_REG_SREG:
+            reg[r] = v & 0x7f;
+            setI(v & 0x80);
+            break;
+        case ACP_REG_TCCR0A: case ACP_REG_TCCR0B: case ACP_REG_OCR0A:
+            t0Sync(); reg[r] = v;
+            break;
+        case ACP_REG_TCNT0:
+            t0Sync(); t0Count = v & 0xff;
+            break;
+        case ACP_REG_TCCR1A: case ACP_REG_TCCR1B: case ACP_REG_OCR1A:
+        case ACP_REG_OCR1B:  case ACP_REG_ICR1:
+            t1Sync(); reg[r] = v;
+            break;
+        case ACP_REG_TCNT1:
+            t1Sync(); t1Count = v;
+            break;
+        default:
+            reg[r] = v;
+    }
+    tick();
+}
+
+void acp_host_cli(void) {tick(); setI(false);}
+void acp_host_sei(void) {tick(); setI(true); dispatch();}
+
+void acp_host_delay_cycles(const uint32_t cycles) {advanceTo(now + cycles);}
+
+// ACP_IDLE(): move on to the next event, or by one cycle if there is none.
+void acp_host_idle(void)
+{
+    uint64_t t = nextEvent();
+    advanceTo(t == NEVER ? now + 1 : t);
+}
+
+// Sleep until an interrupt handler has run, or up to 10 simulated seconds.
+// In ADC noise reduction mode a conversion starts on entry.
+void acp_host_sleep(void)
+{
+    if (!(reg[ACP_REG_SMCR] & _BV(SE))) return;
+    if ((reg[ACP_REG_SMCR] & 0x0e) == SLEEP_MODE_ADC && !converting)
+        startConversion(false, false);
+    uint32_t before = handlersRun;
+    uint64_t limit  = now + (uint64_t)F_CPU * 10;
+    while (handlersRun == before)
+    {
+        uint64_t t = nextEvent();
+        if (t == NEVER || t > limit) break;
+        advanceTo(t);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+// Control panel
+
+namespace ACPHost
+{
+    void reset(void)
+    {
+        for (uint8_t i = 0; i < ACP_REG_COUNT; i++) reg[i] = 0;
+        now = 0; inISR = false;
+        iflag = true;                  // as after the Arduino core's init()
+        converting = false; firstConversion = true; adcData = 0;
+        adcWasOn = false; bgWasOn = false; bgOnSince = 0;
+        refSel = 0; refFrom = aref; refSwitchedAt = 0;
+        t0Count = 0; t0Stamp = 0; t1Count = 0; t1Stamp = 0;
+        clearStats();
+    }
+
+    static uint8_t channel(uint8_t c) {if (c > 13) c -= 14; return c & 0x07;}
+
+    void setPinVoltage(const uint8_t c, const double volts)
+        {pinVolts[channel(c)] = volts; pinSignal[channel(c)] = 0;}
+    void setPinSignal(const uint8_t c, double (*signal)(double))
+        {pinSignal[channel(c)] = signal;}
+    void setSupplyVoltage(const double volts)  {avcc = volts;}
+    void setArefVoltage(const double volts)    {aref = volts;}
+    void setBandgapVoltage(const double volts) {vbg = volts;}
+    void setTemperature(const double celsius)  {tempC = celsius;}
+    void setNoise(const double lsbRms, const uint32_t seed)
+        {noiseLsb = lsbRms; rng = seed ? seed : 1;}
+
+    void     run(const uint32_t c)        {advanceTo(now + c);}
+    void     runMicros(const uint32_t us) {advanceTo(now + (uint64_t)us * (F_CPU / 1000000UL));}
+    uint64_t cycles(void)  {return now;}
+    double   seconds(void) {return (double)now / F_CPU;}
+
+    void int0Edge(void) {setFlag(ACP_REG_EIFR, INTF0, 2); dispatch();}
+
+    void inputCaptureEvent(void)
+    {
+        t1Sync();
+        reg[ACP_REG_ICR1] = t1Count;
+        setFlag(ACP_REG_TIFR1, ICF1, 7);
+        dispatch();
+    }
+
+    Stats stats(void) {return st;}
+    void  clearStats(void) {st = Stats();}
+}
@@ -0,0 +1,87 @@
+#ifndef ACP_HOST_H
+#define ACP_HOST_H
+
+// GvP 2025-10.
+// https://github.com/gvp-257/analogcontrolpanel
+
+/*
+ * Control panel for the host (PC) ADC model: set the voltages the ADC sees,
+ * let time pass, fire external events, and read the counters.
+ *
+ * Time is counted in CPU clock cycles (F_CPU per second). It moves on by one
+ * cycle for each register access, by the requested amount in _delay_us(),
+ * _delay_ms() and run(), to the next event in ACP_IDLE(), and to the next
+ * interrupt in sleep_cpu(). The
+ * library's own instructions are not counted: the model gives ADC timing
+ * and register traffic, not AVR instruction counts.
+ *
+ * Model:
+ *  - Conversions take 13 ADC clocks (25 for the first after ADEN is set,
+ *    13.5 when auto triggered other than free running), starting on the
+ *    next ADC clock edge after ADSC, or at once on an auto trigger (which
+ *    resets the ADC prescaler).
+ *  - Input and reference are latched when a conversion starts, so ADMUX
+ *    changes during a conversion apply to the next one. ADLAR applies
+ *    immediately.
+ *  - Auto trigger on the rising edge of the selected flag: free running,
+ *    INT0 (int0Edge()), Timer0 overflow, Timer1 compare B, Timer1
+ *    overflow, Timer1 input capture (inputCaptureEvent()). A trigger while
+ *    a conversion is running is lost, and counted.
+ *  - Timer0 normal counting; Timer1 normal and CTC (OCR1A or ICR1 top).
+ *  - Interrupts: ADC, Timer0 overflow, Timer1 compare A/B, overflow,
+ *    capture, INT0. The handler runs if its enable bit and the I bit are
+ *    set; its flag is cleared as it starts, as on the AVR.
+ *  - The bandgap takes 70 microseconds to start up after the ADC is
+ *    powered or ACSR's ACBG bit set: readings of it (or with it as
+ *    reference) taken sooner see it low. After a reference change the
+ *    reference settles with a 10 microsecond time constant.
+ *  - PRR's PRADC bit or a clear ADEN stops the ADC.
+ */
+
+#include <avr/io.h>
+
+namespace ACPHost
+{
+    // Power-on state: registers as after reset, time zero, counters clear.
+    // Voltages and noise settings are kept.
+    void reset(void);
+
+    // Signals.
+    // Channel: 0..7 or Arduino A0 (14) .. A7 (21).
+    void setPinVoltage(const uint8_t channel, const double volts);
+    // Time-varying input, instead of a fixed voltage.
+    void setPinSignal(const uint8_t channel, double (*signal)(double seconds));
+    void setSupplyVoltage(const double volts);     // AVCC. Default 5.0
+    void setArefVoltage(const double volts);       // AREF pin. Default 5.0
+    void setBandgapVoltage(const double volts);    // Default 1.1
+    void setTemperature(const double celsius);     // Default 25
+    // Gaussian noise added to every conversion, in LSB (rms). Default 0.
+    void setNoise(const double lsbRms, const uint32_t seed = 1);
+
+    // Time.
+    void     run(const uint32_t cycles);  // the sketch doing other work
+    void     runMicros(const uint32_t us);
+    uint64_t cycles(void);
+    double   seconds(void);
+
+    // External events.
+    void int0Edge(void);                  // sets INTF0
+    void inputCaptureEvent(void);         // copies TCNT1 to ICR1, sets ICF1
+
+    // Counters, since reset() or clearStats().
+    struct Stats
+    {
+        uint32_t registerReads;
+        uint32_t registerWrites;
+        uint32_t conversions;
+        uint32_t adcInterrupts;
+        uint32_t triggersLost;      // trigger while a conversion was running
+        uint32_t interruptsOff;     // times the I bit was cleared
+        uint64_t interruptsOffCycles;
+        uint32_t longestInterruptsOff;   // cycles
+    };
+    Stats stats(void);
+    void  clearStats(void);
+}
+
+#endif
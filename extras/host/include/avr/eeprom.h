@@ -0,0 +1,48 @@
+#ifndef ACP_HOST_AVR_EEPROM_H
+#define ACP_HOST_AVR_EEPROM_H
+
+// GvP 2025-10.
+// Host stand-in for avr-libc's <avr/eeprom.h>: E2END + 1 bytes, erased
+// (0xff) at start. ACPHost::reset() leaves them alone, as a real reset does.
+
+#include <stddef.h>
+#include <avr/io.h>
+
+// Bytes are stored inverted, so the array starts out erased.
+extern uint8_t acp_host_eeprom[E2END + 1];
+
+#define EEMEM
+
+static inline uint8_t eeprom_read_byte(const uint8_t * a)
+    {return ~acp_host_eeprom[(uintptr_t)a & E2END];}
+static inline void eeprom_update_byte(uint8_t * a, const uint8_t v)
+    {acp_host_eeprom[(uintptr_t)a & E2END] = ~v;}
+static inline void eeprom_write_byte(uint8_t * a, const uint8_t v)
+    {eeprom_update_byte(a, v);}
+
+static inline uint16_t eeprom_read_word(const uint16_t * a)
+{
+    const uint8_t * p = (const uint8_t *)a;
+    return eeprom_read_byte(p) | (uint16_t)eeprom_read_byte(p + 1) << 8;
+}
+static inline void eeprom_update_word(uint16_t * a, const uint16_t v)
+{
+    uint8_t * p = (uint8_t *)a;
+    eeprom_update_byte(p, (uint8_t)v);
+    eeprom_update_byte(p + 1, (uint8_t)(v >> 8));
+}
+static inline void eeprom_write_word(uint16_t * a, const uint16_t v)
+    {eeprom_update_word(a, v);}
+
+static inline void eeprom_read_block(void * dst, const void * src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        ((uint8_t *)dst)[i] = eeprom_read_byte((const uint8_t *)src + i);
+}
+static inline void eeprom_update_block(const void * src, void * dst, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        eeprom_update_byte((uint8_t *)dst + i, ((const uint8_t *)src)[i]);
+}
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef ACP_HOST_AVR_INTERRUPT_H
+#define ACP_HOST_AVR_INTERRUPT_H
+
+// GvP 2025-10.
+// Host stand-in for avr-libc's <avr/interrupt.h>. An ISR is an ordinary
+// C function with the vector's name; the model calls it when the hardware
+// would. See ../ACP_Host.h.
+
+#include <avr/io.h>
+
+#define ISR(vector, ...) \
+    extern "C" void vector(void) __VA_ARGS__; extern "C" void vector(void)
+#define EMPTY_INTERRUPT(vector) ISR(vector) {}
+#define ISR_NAKED
+#define ISR_BLOCK
+#define ISR_NOBLOCK
+#define ISR_ALIASOF(target) __attribute__((alias(#target)))
+#define reti()
+
+#endif
@@ -0,0 +1,254 @@
+#ifndef ACP_HOST_AVR_IO_H
+#define ACP_HOST_AVR_IO_H
+
+// GvP 2025-10.
+// https://github.com/gvp-257/analogcontrolpanel
+
+/*
+ * Host (Linux/PC) stand-in for avr-libc's <avr/io.h>, ATmega328P subset.
+ *
+ * The registers are objects that pass every read and write to the ADC model
+ * in ACP_HostModel.cpp, so writing ADSC starts a conversion, ADIF is
+ * cleared by writing 1, timers count, and so on. See ../Readme.md.
+ *
+ * Also defines cli() and sei() (avr-libc has them in <avr/interrupt.h>),
+ * because the library falls back to AVR assembler versions otherwise, and
+ * the library's ACP_IDLE() wait hook.
+ */
+
+#include <stdint.h>
+#include <inttypes.h>
+
+#ifndef F_CPU
+#error "Define F_CPU for the host build, e.g. -DF_CPU=16000000UL"
+#endif
+
+// Register ids for the model.
+enum ACPHostRegId
+{
+    ACP_REG_ADMUX, ACP_REG_ADCSRA, ACP_REG_ADCSRB, ACP_REG_ADCL, ACP_REG_ADCH,
+    ACP_REG_ADC, ACP_REG_DIDR0, ACP_REG_PRR, ACP_REG_SREG, ACP_REG_SMCR,
+    ACP_REG_MCUCR,
+    ACP_REG_TCCR0A, ACP_REG_TCCR0B, ACP_REG_TCNT0, ACP_REG_OCR0A,
+    ACP_REG_OCR0B, ACP_REG_TIMSK0, ACP_REG_TIFR0,
+    ACP_REG_TCCR1A, ACP_REG_TCCR1B, ACP_REG_TCCR1C, ACP_REG_TCNT1,
+    ACP_REG_OCR1A, ACP_REG_OCR1B, ACP_REG_ICR1, ACP_REG_TIMSK1, ACP_REG_TIFR1,
+    ACP_REG_TCCR2A, ACP_REG_TCCR2B, ACP_REG_TCNT2, ACP_REG_OCR2A,
+    ACP_REG_OCR2B, ACP_REG_TIMSK2, ACP_REG_TIFR2, ACP_REG_ASSR,
+    ACP_REG_GTCCR, ACP_REG_EIFR, ACP_REG_EIMSK, ACP_REG_EICRA,
+    ACP_REG_ACSR,
+    ACP_REG_DDRB, ACP_REG_PORTB, ACP_REG_PINB,
+    ACP_REG_DDRC, ACP_REG_PORTC, ACP_REG_PINC,
+    ACP_REG_DDRD, ACP_REG_PORTD, ACP_REG_PIND,
+    ACP_REG_COUNT
+};
+
+uint16_t acp_host_read(const uint8_t reg);
+void     acp_host_write(const uint8_t reg, const uint16_t value);
+void     acp_host_cli(void);
+void     acp_host_sei(void);
+
+// An 8-bit I/O register. Compound assignments are read-modify-write, as on
+// the AVR: ADCSRA |= x writes back a set ADIF and so clears it.
+struct ACPHostReg8
+{
+    const uint8_t id;
+    operator uint8_t() const {return (uint8_t)acp_host_read(id);}
+    ACPHostReg8 & operator=(const uint8_t v)  {acp_host_write(id, v); return *this;}
+    ACPHostReg8 & operator=(const ACPHostReg8 & r) {return *this = (uint8_t)r;}
+    ACPHostReg8 & operator|=(const int v)     {return *this = (uint8_t)(*this | v);}
+    ACPHostReg8 & operator&=(const int v)     {return *this = (uint8_t)(*this & v);}
+    ACPHostReg8 & operator^=(const int v)     {return *this = (uint8_t)(*this ^ v);}
+    ACPHostReg8 & operator+=(const int v)     {return *this = (uint8_t)(*this + v);}
+    ACPHostReg8 & operator-=(const int v)     {return *this = (uint8_t)(*this - v);}
+};
+
+struct ACPHostReg16
+{
+    const uint8_t id;
+    operator uint16_t() const {return acp_host_read(id);}
+    ACPHostReg16 & operator=(const uint16_t v)  {acp_host_write(id, v); return *this;}
+    ACPHostReg16 & operator=(const ACPHostReg16 & r) {return *this = (uint16_t)r;}
+};
+
+extern ACPHostReg8  ADMUX, ADCSRA, ADCSRB, ADCL, ADCH, DIDR0, PRR, SREG, SMCR,
+                    MCUCR,
+                    TCCR0A, TCCR0B, TCNT0, OCR0A, OCR0B, TIMSK0, TIFR0,
+                    TCCR1A, TCCR1B, TCCR1C, TIMSK1, TIFR1,
+                    TCCR2A, TCCR2B, TCNT2, OCR2A, OCR2B, TIMSK2, TIFR2, ASSR,
+                    GTCCR, EIFR, EIMSK, EICRA, ACSR,
+                    DDRB, PORTB, PINB, DDRC, PORTC, PINC, DDRD, PORTD, PIND;
+extern ACPHostReg16 ADC, TCNT1, OCR1A, OCR1B, ICR1;
+#define ADCW ADC
+
+#undef  cli
+#undef  sei
+#define cli() acp_host_cli()
+#define sei() acp_host_sei()
+
+// Waiting for an interrupt flag in RAM: let the model run to its next event.
+void acp_host_idle(void);
+#define ACP_IDLE() acp_host_idle()
+
+// <avr/sfr_defs.h>
+#define _BV(bit) (1 << (bit))
+#define bit_is_set(sfr, bit)   ((sfr) & _BV(bit))
+#define bit_is_clear(sfr, bit) (!((sfr) & _BV(bit)))
+#define loop_until_bit_is_set(sfr, bit)   do { } while (bit_is_clear(sfr, bit))
+#define loop_until_bit_is_clear(sfr, bit) do { } while (bit_is_set(sfr, bit))
+
+// ADC
+#define ADPS0 0
+#define ADPS1 1
+#define ADPS2 2
+#define ADIE  3
+#define ADIF  4
+#define ADATE 5
+#define ADSC  6
+#define ADEN  7
+#define MUX0  0
+#define MUX1  1
+#define MUX2  2
+#define MUX3  3
+#define ADLAR 5
+#define REFS0 6
+#define REFS1 7
+#define ADTS0 0
+#define ADTS1 1
+#define ADTS2 2
+#define ACME  6
+#define ADC0D 0
+#define ADC1D 1
+#define ADC2D 2
+#define ADC3D 3
+#define ADC4D 4
+#define ADC5D 5
+
+// Analog comparator
+#define ACIS0 0
+#define ACIS1 1
+#define ACIC  2
+#define ACIE  3
+#define ACI   4
+#define ACO   5
+#define ACBG  6
+#define ACD   7
+
+// Power reduction
+#define PRADC    0
+#define PRUSART0 1
+#define PRSPI    2
+#define PRTIM1   3
+#define PRTIM0   5
+#define PRTIM2   6
+#define PRTWI    7
+
+// Status register, sleep
+#define SREG_I 7
+#define SE  0
+#define SM0 1
+#define SM1 2
+#define SM2 3
+
+// Timer0
+#define WGM00  0
+#define WGM01  1
+#define COM0B0 4
+#define COM0B1 5
+#define COM0A0 6
+#define COM0A1 7
+#define CS00   0
+#define CS01   1
+#define CS02   2
+#define WGM02  3
+#define TOIE0  0
+#define OCIE0A 1
+#define OCIE0B 2
+#define TOV0   0
+#define OCF0A  1
+#define OCF0B  2
+
+// Timer1
+#define WGM10  0
+#define WGM11  1
+#define COM1B0 4
+#define COM1B1 5
+#define COM1A0 6
+#define COM1A1 7
+#define CS10   0
+#define CS11   1
+#define CS12   2
+#define WGM12  3
+#define WGM13  4
+#define ICES1  6
+#define ICNC1  7
+#define TOIE1  0
+#define OCIE1A 1
+#define OCIE1B 2
+#define ICIE1  5
+#define TOV1   0
+#define OCF1A  1
+#define OCF1B  2
+#define ICF1   5
+
+// Timer2
+#define WGM20  0
+#define WGM21  1
+#define COM2B0 4
+#define COM2B1 5
+#define COM2A0 6
+#define COM2A1 7
+#define CS20   0
+#define CS21   1
+#define CS22   2
+#define WGM22  3
+#define TOIE2  0
+#define OCIE2A 1
+#define OCIE2B 2
+#define TOV2   0
+#define OCF2A  1
+#define OCF2B  2
+#define PSRSYNC 0
+#define PSRASY  1
+#define TSM     7
+
+// External interrupts
+#define INT0  0
+#define INT1  1
+#define INTF0 0
+#define INTF1 1
+
+// Ports
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define DDB0 0
+#define DDB1 1
+#define DDB2 2
+#define DDB3 3
+#define DDB4 4
+#define DDB5 5
+#define PD0 0
+#define PD1 1
+#define PD2 2
+#define PD3 3
+#define PD4 4
+#define PD5 5
+#define PD6 6
+#define PD7 7
+#define DDD0 0
+#define DDD1 1
+#define DDD2 2
+#define DDD3 3
+#define DDD4 4
+#define DDD5 5
+#define DDD6 6
+#define DDD7 7
+
+#define E2END 0x3FF
+#define RAMEND 0x8FF
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef ACP_HOST_AVR_PGMSPACE_H
+#define ACP_HOST_AVR_PGMSPACE_H
+
+// GvP 2025-10.
+// Host stand-in for avr-libc's <avr/pgmspace.h>: one address space, so
+// PROGMEM data is ordinary constant data and the reads are plain loads.
+
+#include <stdint.h>
+
+#define PROGMEM
+
+#define pgm_read_byte(a)  (*(const uint8_t *)(a))
+#define pgm_read_word(a)  (*(const uint16_t *)(a))
+#define pgm_read_dword(a) (*(const uint32_t *)(a))
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef ACP_HOST_AVR_SLEEP_H
+#define ACP_HOST_AVR_SLEEP_H
+
+// GvP 2025-10.
+// Host stand-in for avr-libc's <avr/sleep.h>. sleep_cpu() lets simulated
+// time pass until an interrupt wakes the CPU.
+
+#include <avr/io.h>
+
+#define SLEEP_MODE_IDLE         (0)
+#define SLEEP_MODE_ADC          _BV(SM0)
+#define SLEEP_MODE_PWR_DOWN     _BV(SM1)
+#define SLEEP_MODE_PWR_SAVE     (_BV(SM0) | _BV(SM1))
+#define SLEEP_MODE_STANDBY      (_BV(SM1) | _BV(SM2))
+#define SLEEP_MODE_EXT_STANDBY  (_BV(SM0) | _BV(SM1) | _BV(SM2))
+
+void acp_host_sleep(void);
+
+#define set_sleep_mode(mode) \
+    (SMCR = (uint8_t)((SMCR & ~(_BV(SM0) | _BV(SM1) | _BV(SM2))) | (mode)))
+#define sleep_enable()  (SMCR |= (uint8_t)_BV(SE))
+#define sleep_disable() (SMCR &= (uint8_t)~_BV(SE))
+#define sleep_cpu()     acp_host_sleep()
+#define sleep_mode()    do {sleep_enable(); sleep_cpu(); sleep_disable();} while (0)
+
+#endif
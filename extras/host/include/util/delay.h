@@ -0,0 +1,14 @@
+#ifndef ACP_HOST_UTIL_DELAY_H
+#define ACP_HOST_UTIL_DELAY_H
+
+// GvP 2025-10.
+// Host stand-in for avr-libc's <util/delay.h>: simulated time passes.
+
+#include <avr/io.h>
+
+void acp_host_delay_cycles(const uint32_t cycles);
+
+#define _delay_us(us) acp_host_delay_cycles((uint32_t)((double)(us) * (F_CPU / 1e6)))
+#define _delay_ms(ms) acp_host_delay_cycles((uint32_t)((double)(ms) * (F_CPU / 1e3)))
+
+#endif
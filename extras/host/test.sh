@@ -0,0 +1,30 @@
+#!/bin/sh
+# GvP 2025-10.
+# Build ACPRegression.cpp against the host model, run it, and compare its
+# output with regression.txt. Exit status 1, with the differences, if any
+# line changed. After a deliberate change, check the new numbers and save
+# them as the expected results:
+#
+#   extras/host/test.sh
+#   extras/host/test.sh --update
+
+set -e
+here=$(cd "$(dirname "$0")" && pwd)
+lib="$here/../.."
+build=${TMPDIR:-/tmp}/acphost-test
+
+mkdir -p "$build"
+g++ -std=gnu++11 -DF_CPU=16000000UL -D__AVR_ATmega328P__ \
+    -I "$here/include" -I "$lib/src" -o "$build/regression" \
+    "$here/ACPRegression.cpp" "$lib/src/AnalogControlPanel_M328P.cpp" \
+    "$here/ACP_HostModel.cpp"
+timeout 60 "$build/regression" > "$build/regression.txt"
+
+if [ "$1" = "--update" ]; then
+    cp "$build/regression.txt" "$here/regression.txt"
+    echo "regression.txt updated."
+elif diff -u "$here/regression.txt" "$build/regression.txt"; then
+    echo "All as expected."
+else
+    exit 1
+fi
@@ -0,0 +1,109 @@
+#ifndef ACP_CONFIG_H
+#define ACP_CONFIG_H
+
+// GvP 2025-08.
+// https://github.com/gvp-257/analogcontrolpanel
+
+/*
+ * Compile-time ADC configuration.
+ *
+ * The compiler works out the register values, so switching configuration
+ * costs a few plain stores: no read-modify-write, no arithmetic, no
+ * interrupts-off window. Impossible settings are compile errors.
+ *
+ *   typedef ACPConfig<INTERNAL, 8, 500000UL, ACP_FREE_RUNNING, A2> BurstSetup;
+ *
+ *   BurstSetup::apply();                                // or:
+ *   InternalADC.restoreSettings(BurstSetup::settings());
+ *
+ * The ADC must already be powered on: powerOn() or begin().
+ */
+
+#include <avr/io.h>
+
+// Trigger sources (ADCSRB ADTS bits), for the TRIGGER parameter.
+#define ACP_SINGLE_READING          0xff  // no auto trigger: startReading()
+#define ACP_FREE_RUNNING            0
+#define ACP_TRIGGER_INTERRUPT0      2
+#define ACP_TRIGGER_TIMER0_OVERFLOW 4
+#define ACP_TRIGGER_TIMER1_COMPAREB 5
+#define ACP_TRIGGER_TIMER1_OVERFLOW 6
+#define ACP_TRIGGER_INPUT_CAPTURE   7
+
+// Internal inputs, for the PIN parameter. (Pins are A0..A7, or 0..7.)
+#define ACP_INPUT_TEMPERATURE 0x88
+#define ACP_INPUT_BANDGAP     0x8e
+#define ACP_INPUT_GROUND      0x8f
+
+// Prescaler bits (ADPS2..0) for a clock division ratio; 0 if the prescaler
+// can't do that ratio.
+constexpr uint8_t _acpPrescaleBits(const unsigned long div)
+{
+    return div ==   2 ? 0x01 : div ==  4 ? 0x02 : div ==  8 ? 0x03 :
+           div ==  16 ? 0x04 : div == 32 ? 0x05 : div == 64 ? 0x06 :
+           div == 128 ? 0x07 : 0;
+}
+
+// Prescaler bits for the fastest ADC clock at or below 200 kHz, the fastest
+// the data sheet allows for full 10-bit accuracy.
+constexpr uint8_t _acpAccuratePrescaleBits(const uint8_t bits = 1)
+{
+    return (bits >= 7 || (F_CPU >> bits) <= 200000UL)
+        ? bits : _acpAccuratePrescaleBits(bits + 1);
+}
+
+template <uint8_t REF = DEFAULT, uint8_t BITS = 10,
+          unsigned long CLOCK = 125000UL,
+          uint8_t TRIGGER = ACP_SINGLE_READING, uint8_t PIN = ACP_INPUT_GROUND>
+struct ACPConfig
+{
+    static_assert(REF == DEFAULT || REF == INTERNAL || REF == EXTERNAL,
+                  "ACPConfig: REF must be DEFAULT, INTERNAL or EXTERNAL.");
+    static_assert(BITS == 8 || BITS == 10, "ACPConfig: BITS must be 8 or 10.");
+    static_assert(CLOCK > 0 && F_CPU % CLOCK == 0
+                  && _acpPrescaleBits(F_CPU / CLOCK) != 0,
+                  "ACPConfig: F_CPU / CLOCK must be 2, 4, 8, 16, 32, 64 or 128.");
+    static_assert(TRIGGER == ACP_SINGLE_READING || TRIGGER == ACP_FREE_RUNNING
+                  || (TRIGGER >= ACP_TRIGGER_INTERRUPT0 && TRIGGER <= 7
+                      && TRIGGER != 3),
+                  "ACPConfig: unknown TRIGGER.");
+
+    // MUX value: Arduino A0 = 14, etc., or 0..7, or an internal input.
+    static constexpr uint8_t mux = (PIN & 0x80) ? (PIN & 0x0f)
+                                 : (PIN > 13)   ? ((PIN - 14) & 0x07)
+                                 :                (PIN & 0x07);
+
+    static constexpr uint8_t admux =
+          (REF == DEFAULT  ? (1<<REFS0) :
+           REF == INTERNAL ? ((1<<REFS1) | (1<<REFS0)) : 0)
+        | (BITS == 8 ? (1<<ADLAR) : 0)
+        | mux;
+
+    // Enabled, pending interrupt cleared, done interrupt off.
+    static constexpr uint8_t adcsra =
+          (1<<ADEN) | (1<<ADIF)
+        | (TRIGGER == ACP_SINGLE_READING ? 0 : (1<<ADATE))
+        | _acpPrescaleBits(F_CPU / CLOCK);
+
+    static constexpr uint8_t adcsrb =
+        (TRIGGER == ACP_SINGLE_READING) ? 0 : (TRIGGER & 0x07);
+
+    // Digital input off for pins that have one (A0..A5).
+    static constexpr uint8_t didr0 = (mux < 6) ? (1 << mux) : 0;
+
+    static constexpr InternalADCSettings settings(void)
+        {return InternalADCSettings{adcsra, adcsrb, admux};}
+
+    // ADMUX, ADCSRB, then ADCSRA last so any auto-trigger starts with the new
+    // input and reference. DIDR0 is stored whole as well: only this
+    // configuration's pin (A0..A5) has its digital input off afterwards.
+    static inline void apply(void)
+    {
+        ADMUX  = admux;
+        ADCSRB = adcsrb;
+        ADCSRA = adcsra;
+        DIDR0  = didr0;
+    }
+};
+
+#endif
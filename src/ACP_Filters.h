@@ -0,0 +1,173 @@
+#ifndef ACP_FILTERS_H
+#define ACP_FILTERS_H
+
+// GvP 2025-09.
+// https://github.com/gvp-257/analogcontrolpanel
+
+/*
+ * Streaming filters: one reading in, one filtered reading out, no arrays of
+ * readings kept. Small and quick enough to run in the "conversion complete"
+ * interrupt, or in loop() as readings come out of a ring buffer:
+ *
+ *   ACPMedianFilter<5> despike;
+ *   int smooth = despike.feed(readings.pop());
+ *
+ * Feed a filter from one place only, the interrupt or loop(), not both.
+ *
+ * ACPMedianFilter<N>    median of the last N readings, N = 3, 5 or 7.
+ *                       Removes spikes. Output is (N-1)/2 readings late.
+ * ACPIIRFilter<SHIFT>   single-pole low pass:  y += (x - y) / 2^SHIFT.
+ *                       Time constant about 2^SHIFT readings. SHIFT 1..8.
+ * ACPMovingAverage<SHIFT> average of the last 2^SHIFT readings. SHIFT 1..6.
+ * ACPFilterChain<A, B, ..> A then B then ..
+ *
+ * Each filter starts with its window filled with the first reading.
+ */
+
+#include <avr/io.h>
+
+template <uint8_t N>
+struct ACPMedianFilter
+{
+    static_assert(N == 3 || N == 5 || N == 7,
+                  "ACPMedianFilter: N must be 3, 5 or 7.");
+
+    uint16_t feed(const uint16_t x)
+    {
+        if (!_primed)
+        {
+            for (uint8_t i = 0; i < N; i++) {_byAge[i] = x; _sorted[i] = x;}
+            _oldest = 0;
+            _primed = true;
+            return x;
+        }
+        // Swap the oldest reading for the new one in the age order...
+        uint16_t old = _byAge[_oldest];
+        _byAge[_oldest] = x;
+        if (++_oldest == N) _oldest = 0;
+
+        // ...and in the sorted window: find the old one's place, then slide
+        // the gap left or right to where the new one belongs.
+        uint8_t i = 0;
+        while (_sorted[i] != old) i++;
+        while (i > 0     && _sorted[i - 1] > x) {_sorted[i] = _sorted[i - 1]; i--;}
+        while (i < N - 1 && _sorted[i + 1] < x) {_sorted[i] = _sorted[i + 1]; i++;}
+        _sorted[i] = x;
+
+        return _sorted[N / 2];
+    }
+
+    uint16_t value(void) const {return _sorted[N / 2];}
+    void     reset(void)       {_primed = false;}
+
+private:
+    uint16_t _byAge[N];       // readings, oldest at _oldest
+    uint16_t _sorted[N];      // the same readings, smallest first
+    uint8_t  _oldest = 0;
+    bool     _primed = false;
+};
+
+
+template <uint8_t SHIFT>
+struct ACPIIRFilter
+{
+    static_assert(SHIFT >= 1 && SHIFT <= 8, "ACPIIRFilter: SHIFT must be 1 to 8.");
+
+    // _acc holds y x 2^SHIFT, so no fractions are lost between readings.
+    uint16_t feed(const uint16_t x)
+    {
+        if (!_primed) {_acc = (uint32_t)x << SHIFT; _primed = true;}
+        else          {_acc = _acc - (_acc >> SHIFT) + x;}
+        return value();
+    }
+
+    uint16_t value(void) const
+        {return (uint16_t)((_acc + (1UL << (SHIFT - 1))) >> SHIFT);}
+    void     reset(void) {_primed = false;}
+
+private:
+    uint32_t _acc = 0;
+    bool     _primed = false;
+};
+
+
+template <uint8_t SHIFT>
+struct ACPMovingAverage
+{
+    static_assert(SHIFT >= 1 && SHIFT <= 6,
+                  "ACPMovingAverage: SHIFT must be 1 to 6 (2 to 64 readings).");
+
+    // Running sum: add the new reading, take off the one leaving the window.
+    // 64 x 1023 still fits in 16 bits.
+    uint16_t feed(const uint16_t x)
+    {
+        if (!_primed)
+        {
+            for (uint8_t i = 0; i < SIZE; i++) _window[i] = x;
+            _sum = (uint16_t)(x << SHIFT);
+            _next = 0;
+            _primed = true;
+        }
+        else
+        {
+            _sum += x - _window[_next];
+            _window[_next] = x;
+            _next = (_next + 1) & (SIZE - 1);
+        }
+        return value();
+    }
+
+    uint16_t value(void) const
+        {return (uint16_t)((_sum + (1U << (SHIFT - 1))) >> SHIFT);}
+    void     reset(void) {_primed = false;}
+
+private:
+    static const uint8_t SIZE = 1 << SHIFT;
+    uint16_t _window[SIZE];
+    uint16_t _sum = 0;
+    uint8_t  _next = 0;
+    bool     _primed = false;
+};
+
+
+// Several filters one after the other, e.g. remove spikes then smooth:
+//   ACPFilterChain<ACPMedianFilter<3>, ACPIIRFilter<3> > pipeline;
+template <typename... STAGES> struct ACPFilterChain;
+
+template <> struct ACPFilterChain<>
+{
+    uint16_t feed(const uint16_t x) {return x;}
+};
+
+template <typename FIRST, typename... REST>
+struct ACPFilterChain<FIRST, REST...>
+{
+    FIRST                  first;
+    ACPFilterChain<REST...> rest;
+
+    uint16_t feed(const uint16_t x) {return rest.feed(first.feed(x));}
+};
+
+
+// Internal: done-interrupt function that filters each new reading and
+// queues the result. Use via InternalADC.streamInto(buffer, filter).
+template <typename FILTER, typename BUFFER>
+struct _ACPFilteredFill
+{
+    static FILTER * volatile filter;
+    static BUFFER * volatile buffer;
+
+    static void isr(void)
+    {
+        typename BUFFER::value_type v;
+        _acpLastReading(v);
+        buffer->push((typename BUFFER::value_type)filter->feed(v));
+    }
+};
+
+template <typename FILTER, typename BUFFER>
+FILTER * volatile _ACPFilteredFill<FILTER, BUFFER>::filter = 0;
+template <typename FILTER, typename BUFFER>
+BUFFER * volatile _ACPFilteredFill<FILTER, BUFFER>::buffer = 0;
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef ACP_KEYPAD_H
+#define ACP_KEYPAD_H
+
+// GvP 2025-10.
+// https://github.com/gvp-257/analogcontrolpanel
+
+/*
+ * Resistor-ladder keypad: several buttons on one analog pin, each pulling
+ * it to a different voltage (examples/MultiButtonPin). Decoded in the
+ * "conversion complete" interrupt, so loop() just collects key presses and
+ * releases, and doesn't miss short ones.
+ *
+ * The reading ranges go in a table in flash, in order of reading, with the
+ * key code for each. Key 0 is "no key pressed". Readings between ranges
+ * (contacts bouncing, two keys at once) count as no reading at all: they
+ * are skipped, and don't restart the debounce count.
+ *
+ *   const ACPKeyRange buttons[] PROGMEM = {
+ *       {  0,   40, 1}, { 50,  150, 2}, {250, 350, 3},
+ *       {450,  650, 4}, {700,  870, 5}, {950, 1023, 0}};
+ *
+ *   ACPKeypad<8> keys(buttons, 6, 10);   // 10 readings the same to count
+ *
+ *   InternalADC.usePin(A3);
+ *   InternalADC.triggerOnTimer0Overflow();  // a reading every 1 ms or so
+ *   InternalADC.streamInto(keys);
+ *   loop: uint8_t e = keys.getEvent();
+ *         if (e && !(e & ACP_KEY_RELEASED)) ... key e pressed
+ *
+ * A key counts as pressed (or released) once the debounce count of
+ * readings in a row fall in its range. Each change goes into a queue of
+ * QUEUE events (a power of two, 2 .. 256; one slot is kept empty): the key
+ * code when pressed, with ACP_KEY_RELEASED added when let go. A direct
+ * change from one key to another gives the release, then the press.
+ *
+ * Or while scanning, with the keypad on one of the scanned pins:
+ *   InternalADC.onScanReading(keys.scanFiller(2));   // pins[2]
+ */
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include "ACP_RingBuffer.h"     // _acpLastReading()
+
+// Key codes 1..127; 0 is no key.
+#define ACP_KEY_RELEASED 0x80
+#define ACP_KEY_UNKNOWN  0xff   // reading outside all the ranges
+
+// One table entry: readings low .. high (inclusive) mean key.
+typedef struct {
+    uint16_t low;
+    uint16_t high;
+    uint8_t  key;
+} ACPKeyRange;
+
+template <uint16_t QUEUE>
+struct ACPKeypad
+{
+    static_assert(QUEUE >= 2 && QUEUE <= 256 && (QUEUE & (QUEUE - 1)) == 0,
+                  "ACPKeypad QUEUE must be a power of two, 2 to 256.");
+
+    typedef uint16_t value_type;
+
+    // table: in PROGMEM, numRanges entries in order of reading.
+    // debounce: readings in a row needed for a change, 1 .. 255.
+    ACPKeypad(const ACPKeyRange * table, const uint8_t numRanges,
+              const uint8_t debounce = 5)
+        : _table(table), _numRanges(numRanges),
+          _debounce(debounce ? debounce : 1) {}
+
+    // Key code for a reading, or ACP_KEY_UNKNOWN. Binary search: the first
+    // range whose top is at or above the reading, then check its bottom.
+    uint8_t classify(const uint16_t reading) const
+    {
+        uint8_t lo = 0, hi = _numRanges;
+        while (lo < hi)
+        {
+            uint8_t mid = (lo + hi) >> 1;
+            if (pgm_read_word(&_table[mid].high) < reading) lo = mid + 1;
+            else                                           hi = mid;
+        }
+        if (lo == _numRanges || reading < pgm_read_word(&_table[lo].low))
+            return ACP_KEY_UNKNOWN;
+        return pgm_read_byte(&_table[lo].key);
+    }
+
+    // INTERRUPT SIDE
+
+    // Add a reading.
+    // Readings between the ranges are skipped: they neither add to the
+    // run of readings in a row nor break it.
+    inline void push(const uint16_t reading)
+    {
+        uint8_t k = classify(reading);
+        if (k == ACP_KEY_UNKNOWN) return;
+        if (k != _candidate) {_candidate = k; _same = 0;}
+        if (_same < _debounce && ++_same == _debounce && k != _key)
+        {
+            if (_key) _queue(_key | ACP_KEY_RELEASED);
+            if (k)    _queue(k);
+            _key = k;
+        }
+    }
+
+    // LOOP SIDE
+
+    bool    available(void) const {return _head != _tail;}
+    // Next event, oldest first: key code, + ACP_KEY_RELEASED for a
+    // release. 0 if there are none.
+    uint8_t getEvent(void)
+    {
+        uint8_t t = _tail;
+        if (_head == t) return 0;
+        uint8_t e = _events[t];
+        _tail = (t + 1) & (QUEUE - 1);   // publish only after the read.
+        return e;
+    }
+    uint8_t key(void) const {return _key;}      // pressed now, 0 for none
+    // Events dropped because the queue was full, up to 255.
+    uint8_t overruns(void) const {return _overruns;}
+
+    // Forget keys and events. Stop the readings going in first.
+    void clear(void)
+    {
+        _head = 0; _tail = 0; _overruns = 0;
+        _key = 0; _candidate = 0; _same = 0;
+    }
+
+
+    // Done-interrupt function that pushes each new reading into this keypad.
+    // Use via InternalADC.streamInto(keypad).
+    typedef void (*fillfnptr)();
+    fillfnptr adcFiller(void) {_target = this; return _fillFromADC;}
+
+    // For InternalADC.onScanReading(): readings of scan list entry index.
+    typedef void (*scanfnptr)(const uint8_t, const int);
+    scanfnptr scanFiller(const uint8_t index)
+        {_target = this; _scanIndex = index; return _fillFromScan;}
+
+private:
+    const ACPKeyRange * _table;
+    uint8_t  _numRanges;
+    uint8_t  _debounce;
+
+    volatile uint8_t _key = 0;          // debounced key
+    uint8_t  _candidate = 0;            // latest reading's key
+    uint8_t  _same = 0;                 // readings in a row with it
+
+    volatile uint8_t _head = 0;         // written only by the interrupt side
+    volatile uint8_t _tail = 0;         // written only by loop()
+    volatile uint8_t _overruns = 0;
+    volatile uint8_t _events[QUEUE];
+
+    inline void _queue(const uint8_t e)
+    {
+        uint8_t h = _head, next = (h + 1) & (QUEUE - 1);
+        if (next == _tail) {if (_overruns != 0xff) _overruns++; return;}
+        _events[h] = e;
+        _head = next;           // publish only after the event is stored.
+    }
+
+    static ACPKeypad * volatile _target;
+    static uint8_t              _scanIndex;
+
+    static void _fillFromADC(void) {uint16_t v; _acpLastReading(v); _target->push(v);}
+    static void _fillFromScan(const uint8_t index, const int reading)
+        {if (index == _scanIndex) _target->push((uint16_t)reading);}
+};
+
+template <uint16_t QUEUE>
+ACPKeypad<QUEUE> * volatile ACPKeypad<QUEUE>::_target = 0;
+template <uint16_t QUEUE>
+uint8_t ACPKeypad<QUEUE>::_scanIndex = 0;
+
+#endif
@@ -15,7 +15,52 @@ extern "C"{
     // volatile voidfnptr _ADCDoneFunc = _ADCdefaultISR;
     volatile voidfnptr _ADCDoneFunc;
 
+#ifdef ACP_INSTRUMENT
+    // Counters (InternalADC.counters()): each reading, and how long the
+    // done function took by Timer1.
+    void _acpCountReading(const bool forSketch);
+    void _acpCountInterruptTime(const uint16_t start);
+    void _acpCountTrigger(void);
+
+    ISR(ADC_vect)
+    {
+        uint16_t start = TCNT1;
+        _acpCountReading(!_ADCDoneFunc);
+        if (_ADCDoneFunc) (*_ADCDoneFunc)();
+        _acpCountInterruptTime(start);
+    }
+#else
     ISR(ADC_vect) {if (_ADCDoneFunc) (*_ADCDoneFunc)();}
+#endif
+
+    // For sampleAt(): Timer1's compare match B flag only triggers the ADC
+    // again once it has been cleared, and running an interrupt clears it.
+    // Nothing else to do, so just return. Weak: a sketch or library with its
+    // own TIMER1_COMPB_vect (Servo, TimerOne, ...) replaces this one. So the
+    // vector is an alias of a handler with a name of its own, and sampleAt()
+    // compares the two to see whose it is. ("__vector": avr-gcc takes it for
+    // an interrupt handler.)
+#ifdef ACP_INSTRUMENT
+    ISR(__vector_acpTimer1CompB) {_acpCountTrigger();}
+#else
+    ISR(__vector_acpTimer1CompB, ISR_NAKED) {reti();}
+#endif
+    ISR(TIMER1_COMPB_vect, ISR_ALIASOF(__vector_acpTimer1CompB) __attribute__((weak)));
+
+    // For startTimestamps(): Timer1 overflows, the top 16 bits of the
+    // 32-bit timestamp clock. Also clears TOV1 for triggerOnTimer1Overflow().
+    // Weak, and an alias, as above: startTimestamps() checks it.
+    volatile uint16_t _acpTimer1High;
+#ifdef ACP_INSTRUMENT
+    ISR(__vector_acpTimer1Ovf)
+    {
+        _acpTimer1High++;
+        if ((ADCSRB & 0x07) == 0x06) _acpCountTrigger();
+    }
+#else
+    ISR(__vector_acpTimer1Ovf) {_acpTimer1High++;}
+#endif
+    ISR(TIMER1_OVF_vect, ISR_ALIASOF(__vector_acpTimer1Ovf) __attribute__((weak)));
 #ifdef __cplusplus
 };
 #endif
@@ -0,0 +1,201 @@
+#ifndef ACP_PACKEDBUFFER_H
+#define ACP_PACKEDBUFFER_H
+
+// GvP 2025-10.
+// https://github.com/gvp-257/analogcontrolpanel
+
+/*
+ * Compact sample store: more 10-bit readings in the same RAM, for loggers
+ * that collect a block of readings before writing it to an SD card.
+ *
+ * Filled in order by the "conversion complete" interrupt (or push() from
+ * loop()), read back in order with next(), or written out whole as bytes
+ * with data() and bytes() and unpacked on the PC (extras/decode).
+ *
+ * ACP_PACK_10BIT  four readings in five bytes: 1.6 times as many as an
+ *                 int array. Any signal.
+ * ACP_PACK_DELTA  each reading as the change from the one before: one byte
+ *                 for changes of -64 .. +63, two bytes otherwise. Twice as
+ *                 many as an int array for slowly changing signals (the
+ *                 usual logger temperatures, light, battery), never fewer
+ *                 than an int array.
+ *
+ *   ACPPacked10<500>    block;       // 500 bytes RAM, 400 readings
+ *   ACPPackedDelta<500> slowBlock;   // 500 bytes RAM, 250 .. 500 readings
+ *
+ *   InternalADC.streamInto(block);   // or block.push(InternalADC.read());
+ *   ...
+ *   uint16_t r;
+ *   block.rewind();
+ *   while (block.next(r)) {...}
+ *
+ * One writer (the interrupt), one reader (loop()). Unlike the ring buffer
+ * it doesn't wrap round: when it's full, readings are dropped and counted
+ * in overruns() until clear().
+ *
+ * Storage format, byte by byte (what data() gives and extras/decode reads):
+ *  10BIT: groups of five bytes. Bytes 0..3 are the low 8 bits of readings
+ *         0..3; byte 4 holds their top 2 bits, reading 0 in bits 0-1,
+ *         reading 1 in bits 2-3, and so on. A part-filled last group has
+ *         its byte 4, and unused low bytes.
+ *  DELTA: d = reading - previous reading (previous = 0 for the first),
+ *         zig-zag coded z = 2d for d >= 0, -2d - 1 for d < 0, then z in
+ *         7-bit groups, low group first, bit 7 set on all but the last
+ *         byte. z is at most 2047 here, so one or two bytes.
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>      // cli()
+#include "ACP_RingBuffer.h"     // _acpLastReading()
+
+#define ACP_PACK_10BIT 0
+#define ACP_PACK_DELTA 1
+
+// Internal: zig-zag code a 16-bit difference, and back.
+static inline uint16_t _acpZigZag(const int16_t d)
+    {return (uint16_t)((uint16_t)d << 1) ^ (uint16_t)(d >> 15);}
+static inline int16_t _acpUnZigZag(const uint16_t z)
+    {return (int16_t)(z >> 1) ^ -(int16_t)(z & 1);}
+
+template <uint16_t BYTES, uint8_t MODE>
+struct ACPPackedBuffer
+{
+    static_assert(MODE == ACP_PACK_10BIT || MODE == ACP_PACK_DELTA,
+                  "ACPPackedBuffer MODE must be ACP_PACK_10BIT or ACP_PACK_DELTA.");
+    static_assert(BYTES >= 5, "ACPPackedBuffer needs 5 bytes or more.");
+
+    typedef uint16_t value_type;
+
+    // INTERRUPT SIDE
+
+    // Add a reading, 0..1023. If it doesn't fit it is dropped and counted
+    // in overruns().
+    inline bool push(const uint16_t value)
+    {
+        uint16_t n = _count, used = _used;
+        if (MODE == ACP_PACK_10BIT)
+        {
+            uint8_t k = n & 3;
+            if (k == 0)
+            {
+                if (used > BYTES - 5) return _overrun();
+                _data[used + 4] = (uint8_t)(value >> 8) & 0x03;
+                used += 5;
+            }
+            else _data[used - 1] |= (uint8_t)((value >> 8) & 0x03) << (2 * k);
+            _data[used - 5 + k] = (uint8_t)value;
+        }
+        else
+        {
+            uint16_t z = _acpZigZag((int16_t)(value - _last));
+            if (z < 0x80)
+            {
+                if (used >= BYTES) return _overrun();
+                _data[used++] = (uint8_t)z;
+            }
+            else
+            {
+                if (used > BYTES - 2) return _overrun();
+                _data[used++] = (uint8_t)z | 0x80;
+                _data[used++] = (uint8_t)(z >> 7);
+            }
+            _last = value;
+        }
+        _used  = used;
+        _count = n + 1;         // publish only after the data is stored.
+        return true;
+    }
+
+    // LOOP SIDE
+
+    // These leave interrupts as they found them: safe from a done function.
+
+    // Readings stored, and bytes used (to write data() out).
+    uint16_t count(void) const
+        {uint8_t s = SREG; cli(); uint16_t n = _count; SREG = s; return n;}
+    uint16_t bytes(void) const
+        {uint8_t s = SREG; cli(); uint16_t n = _used;  SREG = s; return n;}
+    // No room for another reading (for ACP_PACK_DELTA, a two-byte one).
+    bool full(void) const
+    {
+        uint8_t s = SREG;
+        cli(); uint16_t n = _count, used = _used; SREG = s;
+        if (MODE == ACP_PACK_10BIT) return (n & 3) == 0 && used > BYTES - 5;
+        return used > BYTES - 2;
+    }
+    const uint8_t * data(void) const {return (const uint8_t *)_data;}
+
+    // Read back in order: rewind(), then next(value) until it returns false.
+    // Readings pushed meanwhile are read too.
+    void rewind(void) {_readCount = 0; _readPos = 0; _readLast = 0;}
+    bool next(uint16_t & value)
+    {
+        if (_readCount >= count()) return false;
+        if (MODE == ACP_PACK_10BIT)
+        {
+            uint8_t k = _readCount & 3;
+            uint16_t g = _readPos;
+            value = _data[g + k] | ((uint16_t)((_data[g + 4] >> (2 * k)) & 0x03) << 8);
+            if (k == 3) _readPos = g + 5;
+        }
+        else
+        {
+            uint16_t z = _data[_readPos++];
+            if (z & 0x80) z = (z & 0x7f) | ((uint16_t)_data[_readPos++] << 7);
+            _readLast += _acpUnZigZag(z);
+            value = _readLast;
+        }
+        _readCount++;
+        return true;
+    }
+
+    // Readings dropped because it was full, up to 255.
+    uint8_t overruns(void) const {return _overruns;}
+
+    // Empty it, ready for the next block. Stop the readings going in first
+    // (stopStreaming()).
+    void clear(void)
+    {
+        uint8_t s = SREG;
+        cli();
+        _count = 0; _used = 0; _last = 0; _overruns = 0;
+        SREG = s;
+        rewind();
+    }
+
+    // Capacity in readings: exact for ACP_PACK_10BIT, the least for
+    // ACP_PACK_DELTA.
+    uint16_t capacity(void) const
+        {return (MODE == ACP_PACK_10BIT) ? (BYTES / 5) * 4 : BYTES / 2;}
+
+
+    // Done-interrupt function that pushes each new reading into this buffer.
+    // Use via InternalADC.streamInto(buffer).
+    typedef void (*fillfnptr)();
+    fillfnptr adcFiller(void) {_target = this; return _fillFromADC;}
+
+private:
+    volatile uint16_t _count = 0;     // written only by the interrupt side
+    volatile uint16_t _used  = 0;
+    uint16_t          _last  = 0;     // previous reading, ACP_PACK_DELTA
+    volatile uint8_t  _overruns = 0;
+    volatile uint8_t  _data[BYTES];
+
+    uint16_t _readCount = 0;          // loop side
+    uint16_t _readPos   = 0;
+    uint16_t _readLast  = 0;
+
+    inline bool _overrun(void) {if (_overruns != 0xff) _overruns++; return false;}
+
+    static ACPPackedBuffer * volatile _target;
+
+    static void _fillFromADC(void) {uint16_t v; _acpLastReading(v); _target->push(v);}
+};
+
+template <uint16_t BYTES, uint8_t MODE>
+ACPPackedBuffer<BYTES, MODE> * volatile ACPPackedBuffer<BYTES, MODE>::_target = 0;
+
+template <uint16_t BYTES> using ACPPacked10    = ACPPackedBuffer<BYTES, ACP_PACK_10BIT>;
+template <uint16_t BYTES> using ACPPackedDelta = ACPPackedBuffer<BYTES, ACP_PACK_DELTA>;
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef ACP_PINGPONGBUFFER_H
+#define ACP_PINGPONGBUFFER_H
+
+// GvP 2025-10.
+// https://github.com/gvp-257/analogcontrolpanel
+
+/*
+ * Double ("ping-pong") buffer: the "conversion complete" interrupt fills one
+ * block of N readings while loop() writes out the other, to an SD card or
+ * serial port, say. No gaps as long as loop() gets a block written in the
+ * time it takes to fill the next.
+ *
+ * When a block is full the interrupt hands it over (ready() is true, and the
+ * block-ready function is called if there is one) and carries on into the
+ * other block. loop() must release() a block before the next one fills: if
+ * it hasn't, the full block is kept, readings are dropped and counted in
+ * overruns() until it does.
+ *
+ *   ACPPingPong16<128> blocks;           // 2 x 128 readings, 512 bytes RAM
+ *
+ *   InternalADC.streamInto(blocks);
+ *   loop: if (blocks.ready()) {
+ *             logFile.write((const uint8_t *)blocks.block(), blocks.blockBytes());
+ *             blocks.release();
+ *         }
+ *
+ * Only the interrupt changes which block is filling, and only loop()
+ * releases, each with a one-byte store, so neither side turns interrupts off.
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>      // cli()
+#include "ACP_RingBuffer.h"     // _acpLastReading()
+
+template <typename T, uint16_t N>
+struct ACPPingPong
+{
+    static_assert(N >= 1, "ACPPingPong needs at least one reading per block.");
+
+    typedef T value_type;
+
+    // INTERRUPT SIDE
+
+    // Add a reading. Hands the block over when it is full. Returns false,
+    // and counts an overrun, if both blocks are full.
+    inline bool push(const T value)
+    {
+        if (_pos >= N)                  // full, waiting for a release()
+        {
+            if (_ready != NONE)
+            {
+                if (_overruns != 0xff) _overruns++;
+                return false;
+            }
+            _handOver();
+        }
+        _data[_fill][_pos++] = value;
+        if (_pos >= N && _ready == NONE) _handOver();
+        return true;
+    }
+
+    // Function called from the interrupt each time a block is ready. Keep it
+    // short: set a flag, or wake a task. Or 0 for none.
+    void onBlockReady(void (*fn)(void)) {_readyFunc = fn;}
+
+    // LOOP SIDE
+
+    bool     ready(void) const {return _ready != NONE;}
+    // The block that is ready: check ready() first.
+    const T * block(void) const {return (const T *)_data[_ready];}
+    uint16_t blockLength(void) const {return _readyLength;}   // readings
+    uint16_t blockBytes(void)  const {return _readyLength * sizeof(T);}
+    // Done with the block: the interrupt can fill it again.
+    void     release(void) {_ready = NONE;}
+
+    uint16_t capacity(void) const {return N;}     // readings per block
+    uint16_t blocks(void)   const                 // handed over so far
+        {uint8_t s = SREG; cli(); uint16_t n = _blocks; SREG = s; return n;}
+
+    // Readings dropped because both blocks were full, up to 255.
+    uint8_t overruns(void) const {return _overruns;}
+    void    clearOverruns(void)  {_overruns = 0;}
+
+    // After stopStreaming(): hand over the part-filled block, if any, so
+    // that the last readings can be written out too. Returns false if there
+    // was nothing to hand over, or the last block isn't released yet.
+    bool flush(void)
+    {
+        if (_ready != NONE || _pos == 0) return false;
+        _handOver();
+        return true;
+    }
+
+    // Start again, empty. Stop the readings going in first (stopStreaming()).
+    void clear(void)
+    {
+        _fill = 0; _pos = 0; _ready = NONE; _overruns = 0;
+        _blocks = 0;
+    }
+
+
+    // Done-interrupt function that pushes each new reading into this buffer.
+    // Use via InternalADC.streamInto(buffer).
+    typedef void (*fillfnptr)();
+    fillfnptr adcFiller(void) {_target = this; return _fillFromADC;}
+
+private:
+    static const uint8_t NONE = 0xff;
+
+    volatile uint8_t  _fill = 0;          // block being filled, 0 or 1
+    volatile uint16_t _pos  = 0;          // readings in it
+    volatile uint8_t  _ready = NONE;      // block handed over, or NONE
+    volatile uint16_t _readyLength = 0;
+    volatile uint16_t _blocks = 0;
+    volatile uint8_t  _overruns = 0;
+    void (* volatile  _readyFunc)(void) = 0;
+    volatile T        _data[2][N];
+
+    inline void _handOver(void)
+    {
+        uint8_t f = _fill;
+        _readyLength = _pos;
+        _fill  = f ^ 1;
+        _pos   = 0;
+        _blocks++;
+        _ready = f;             // publish only after the rest is set.
+        if (_readyFunc) (*_readyFunc)();
+    }
+
+    static ACPPingPong * volatile _target;
+
+    static void _fillFromADC(void) {T v; _acpLastReading(v); _target->push(v);}
+};
+
+template <typename T, uint16_t N>
+ACPPingPong<T, N> * volatile ACPPingPong<T, N>::_target = 0;
+
+template <uint16_t N> using ACPPingPong8  = ACPPingPong<uint8_t,  N>;
+template <uint16_t N> using ACPPingPong16 = ACPPingPong<uint16_t, N>;
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef ACP_RINGBUFFER_H
+#define ACP_RINGBUFFER_H
+
+// GvP 2025-08.
+// https://github.com/gvp-257/analogcontrolpanel
+
+/*
+ * Sample queue from the "ADC conversion complete" interrupt to loop().
+ *
+ * One writer (the interrupt) and one reader (loop()). Each side only ever
+ * writes its own one-byte index, and one-byte loads and stores can't be
+ * interrupted halfway on the AVR, so neither side needs to turn interrupts
+ * off.
+ *
+ * SIZE must be a power of two, 2 .. 256. One slot is kept empty to tell
+ * "full" from "empty", so the buffer holds SIZE - 1 readings.
+ *
+ *   ACPRingBuffer8<128>  byteReadings;   // for bitDepth8(), 128 bytes RAM
+ *   ACPRingBuffer16<64>  readings;       // 0..1023, 128 bytes RAM
+ */
+
+#include <avr/io.h>
+
+// Internal: the latest reading, as a buffer of that type stores it.
+// 8-bit buffers get the top 8 bits (ADCH), for use with bitDepth8().
+static inline void _acpLastReading(uint8_t & v)  {v = ADCH;}
+static inline void _acpLastReading(uint16_t & v)
+    {if (bit_is_set(ADMUX, ADLAR)) v = ADCH; else v = ADC;}
+
+template <typename T, uint16_t SIZE>
+struct ACPRingBuffer
+{
+    static_assert(SIZE >= 2 && SIZE <= 256 && (SIZE & (SIZE - 1)) == 0,
+                  "ACPRingBuffer SIZE must be a power of two, 2 to 256.");
+
+    typedef T value_type;
+
+    // INTERRUPT SIDE
+
+    // Add a reading. If the buffer is full the reading is dropped and
+    // counted in overruns().
+    inline bool push(const T value)
+    {
+        uint8_t h    = _head;
+        uint8_t next = (h + 1) & MASK;
+        if (next == _tail)
+        {
+            if (_overruns != 0xff) _overruns++;
+            return false;
+        }
+        _data[h] = value;
+        _head = next;           // publish only after the data is stored.
+        return true;
+    }
+
+    // LOOP SIDE
+
+    bool    available(void) const {return _head != _tail;}
+    uint8_t count(void)     const {return (uint8_t)((_head - _tail) & MASK);}
+    uint8_t capacity(void)  const {return (uint8_t)(SIZE - 1);}
+
+    // Oldest reading. Check available() first.
+    T peek(void) const {return _data[_tail];}
+
+    // Take the oldest reading out. Check available() first.
+    T pop(void)
+    {
+        uint8_t t = _tail;
+        T value = _data[t];
+        _tail = (t + 1) & MASK; // free the slot only after it's been read.
+        return value;
+    }
+
+    // Readings dropped because the buffer was full, up to 255.
+    uint8_t overruns(void) const {return _overruns;}
+    void    clearOverruns(void)  {_overruns = 0;}
+
+    // Throw away all readings. Reader side: only moves the read index.
+    void    clear(void) {_tail = _head;}
+
+
+    // Done-interrupt function that pushes each new reading into this buffer.
+    // Use via InternalADC.streamInto(buffer).
+    typedef void (*fillfnptr)();
+    fillfnptr adcFiller(void) {_target = this; return _fillFromADC;}
+
+private:
+    static const uint8_t MASK = (uint8_t)(SIZE - 1);
+
+    volatile uint8_t _head = 0;      // written only by the interrupt
+    volatile uint8_t _tail = 0;      // written only by loop()
+    volatile uint8_t _overruns = 0;
+    volatile T       _data[SIZE];
+
+    static ACPRingBuffer * volatile _target;
+
+    static void _fillFromADC(void) {T v; _acpLastReading(v); _target->push(v);}
+};
+
+template <typename T, uint16_t SIZE>
+ACPRingBuffer<T, SIZE> * volatile ACPRingBuffer<T, SIZE>::_target = 0;
+
+template <uint16_t SIZE> using ACPRingBuffer8  = ACPRingBuffer<uint8_t,  SIZE>;
+template <uint16_t SIZE> using ACPRingBuffer16 = ACPRingBuffer<uint16_t, SIZE>;
+
+#endif
@@ -0,0 +1,198 @@
+#ifndef ACP_STATS_H
+#define ACP_STATS_H
+
+// GvP 2025-10.
+// https://github.com/gvp-257/analogcontrolpanel
+
+/*
+ * Running statistics of readings, kept by the "conversion complete"
+ * interrupt: count, mean, variance, min, max, and optionally a histogram of
+ * each reading's difference from a centre value. One pass, no buffer of
+ * readings, no time in loop() until it asks for a summary.
+ *
+ *   ACPStats<9> noise;                 // histogram -4+ .. +4+, 42 bytes RAM
+ *
+ *   InternalADC.usePin(A3);
+ *   InternalADC.freeRunningMode();
+ *   InternalADC.streamInto(noise);
+ *   loop: ACPStats<9>::Summary s = noise.summary(true);   // and restart
+ *         ... s.count, s.mean(), s.stddev(), s.min, s.max, s.bin(-1) ...
+ *
+ * The interrupt adds up each reading's difference from the centre, and the
+ * squares of those, in integers: exact, with no rounding to pile up, and
+ * only a few adds and one 16-bit multiply per reading. The centre is the
+ * first reading, or after summary(true) the last summary's mean, unless
+ * set with setCenter(). It stops adding at 65535 readings (full()).
+ *
+ * BINS is 0 for no histogram, or odd, 3 .. 31: bin(0) counts readings
+ * equal to the centre, bin(1) one above, and so on; the end bins also
+ * count everything beyond them.
+ *
+ * Or while scanning, for one of the scanned pins:
+ *   InternalADC.onScanReading(noise.scanFiller(2));  // pins[2]
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>      // cli()
+#include <math.h>               // sqrt()
+#include "ACP_RingBuffer.h"     // _acpLastReading()
+
+template <uint8_t BINS = 0>
+struct ACPStats
+{
+    static_assert(BINS == 0 || (BINS >= 3 && BINS <= 31 && (BINS & 1)),
+                  "ACPStats BINS must be 0, or odd, 3 to 31.");
+
+    typedef uint16_t value_type;
+
+    // A consistent copy of the statistics, from summary().
+    struct Summary
+    {
+        uint16_t count;
+        uint16_t min, max;
+        uint16_t center;
+        int32_t  sum;           // of (reading - center)
+        uint64_t squares;       // of (reading - center) squared
+        uint16_t bins[BINS ? BINS : 1];
+
+        float mean(void) const
+            {return count ? center + (float)sum / count : 0.0;}
+        // Sample variance (divides by count - 1), readings squared.
+        float variance(void) const
+        {
+            if (count < 2) return 0.0;
+            float v = ((float)squares - (float)sum * sum / count) / (count - 1);
+            return v > 0.0 ? v : 0.0;
+        }
+        float stddev(void) const {return sqrt(variance());}
+        // Mean in 1/16ths of a step, rounded: integer arithmetic only.
+        int32_t mean16(void) const
+        {
+            if (!count) return 0;
+            int32_t s = sum * 16;
+            s += s < 0 ? -(int32_t)(count / 2) : (int32_t)(count / 2);
+            return (int32_t)center * 16 + s / (int32_t)count;
+        }
+        // Readings offset from the centre, -BINS/2 .. +BINS/2.
+        uint16_t bin(const int8_t offset) const
+        {
+            int8_t b = offset + (int8_t)(BINS / 2);
+            return (BINS && b >= 0 && b < (int8_t)BINS) ? bins[b] : 0;
+        }
+    };
+
+    // INTERRUPT SIDE
+
+    // Add a reading.
+    inline void push(const uint16_t reading)
+    {
+        if (_count == 0xffff) return;                   // full
+        if (_count == 0)
+        {
+            if (!_centerSet && !_centerKept) _center = reading;
+            _min = reading; _max = reading;
+        }
+        else
+        {
+            if (reading < _min) _min = reading;
+            if (reading > _max) _max = reading;
+        }
+        int16_t d = (int16_t)(reading - _center);
+        _sum += d;
+        uint16_t a = d < 0 ? -d : d;
+        _squares += (uint32_t)a * a;
+        if (BINS)
+        {
+            int16_t b = d + (int16_t)(BINS / 2);
+            if (b < 0) b = 0;
+            if (b > (int16_t)(BINS - 1)) b = BINS - 1;
+            _bins[b]++;             // can't overflow: _count is the limit
+        }
+        _count++;
+    }
+
+    // LOOP SIDE
+
+    uint16_t count(void) const {uint8_t s = SREG; cli(); uint16_t n = _count; SREG = s; return n;}
+    bool     full(void)  const {return count() == 0xffff;}
+
+    // Copy of everything so far, taken with interrupts off. restart:
+    // clear them in the same breath, for per-interval summaries.
+    Summary summary(const bool restart = false)
+    {
+        Summary s;
+        uint8_t sreg = SREG; cli();
+        s.count = _count; s.min = _min; s.max = _max; s.center = _center;
+        s.sum = _sum; s.squares = _squares;
+        for (uint8_t i = 0; i < (BINS ? BINS : 1); i++)
+            s.bins[i] = BINS ? _bins[i] : 0;
+        if (restart)
+        {
+            _clear();
+            if (!_centerSet && s.count)     // centre the next on this mean
+            {
+                _center = (uint16_t)((s.mean16() + 8) >> 4);
+                _centerKept = true;
+            }
+        }
+        SREG = sreg;
+        return s;
+    }
+
+    // Histogram centre, and reference for the sums. Takes effect from the
+    // next clear() (or now, if there are no readings yet).
+    void setCenter(const uint16_t center)
+    {
+        uint8_t s = SREG; cli();
+        _centerSet = true; _newCenter = center;
+        if (_count == 0) _center = center;
+        SREG = s;
+    }
+    // Back to centring on the first reading.
+    void autoCenter(void) {uint8_t s = SREG; cli(); _centerSet = false; _centerKept = false; SREG = s;}
+
+    void clear(void) {uint8_t s = SREG; cli(); _clear(); SREG = s;}
+
+
+    // Done-interrupt function that pushes each new reading into these
+    // statistics. Use via InternalADC.streamInto(stats).
+    typedef void (*fillfnptr)();
+    fillfnptr adcFiller(void) {clear(); _target = this; return _fillFromADC;}
+
+    // For InternalADC.onScanReading(): readings of scan list entry index.
+    typedef void (*scanfnptr)(const uint8_t, const int);
+    scanfnptr scanFiller(const uint8_t index)
+        {clear(); _target = this; _scanIndex = index; return _fillFromScan;}
+
+private:
+    volatile uint16_t _count = 0;
+    uint16_t _min = 0, _max = 0;
+    uint16_t _center = 0, _newCenter = 0;
+    bool     _centerSet = false;        // by setCenter()
+    bool     _centerKept = false;       // from the last summary(true)
+    int32_t  _sum = 0;
+    uint64_t _squares = 0;
+    uint16_t _bins[BINS ? BINS : 1] = {};
+
+    void _clear(void)
+    {
+        _count = 0; _sum = 0; _squares = 0; _min = 0; _max = 0;
+        if (_centerSet) _center = _newCenter;
+        _centerKept = false;
+        for (uint8_t i = 0; i < (BINS ? BINS : 1); i++) _bins[i] = 0;
+    }
+
+    static ACPStats * volatile _target;
+    static uint8_t             _scanIndex;
+
+    static void _fillFromADC(void) {uint16_t v; _acpLastReading(v); _target->push(v);}
+    static void _fillFromScan(const uint8_t index, const int reading)
+        {if (index == _scanIndex) _target->push((uint16_t)reading);}
+};
+
+template <uint8_t BINS>
+ACPStats<BINS> * volatile ACPStats<BINS>::_target = 0;
+template <uint8_t BINS>
+uint8_t ACPStats<BINS>::_scanIndex = 0;
+
+#endif
@@ -0,0 +1,191 @@
+#ifndef ACP_TIMESTAMPS_H
+#define ACP_TIMESTAMPS_H
+
+// GvP 2025-10.
+// https://github.com/gvp-257/analogcontrolpanel
+
+/*
+ * Timestamped readings: each reading from the "conversion complete"
+ * interrupt goes into the queue with the time it was taken, on Timer1
+ * extended to 32 bits (InternalADC.startTimestamps()). No micros() calls,
+ * which are slow and late whenever another interrupt is running.
+ *
+ * With triggerOnInputCapture(), the time is the trigger itself: the edge on
+ * pin 8, captured by Timer1 in hardware (ICR1). Exact to one Timer1 tick
+ * whatever else is going on. Otherwise it is the time the interrupt ran:
+ * a fixed conversion time after the trigger, plus however long the
+ * interrupt was kept waiting.
+ *
+ *   ACPStampedBuffer<16> stamped;         // 15 readings, 96 bytes RAM
+ *
+ *   InternalADC.startTimestamps();        // Timer1 at F_CPU / 8
+ *   InternalADC.usePin(A0);
+ *   InternalADC.triggerOnInputCapture();  // GPS PPS on pin 8
+ *   InternalADC.streamInto(stamped);
+ *   loop: ACPStampedReading r;
+ *         while (stamped.pop(r)) {... r.reading, r.time ...}
+ *
+ * The interrupt also keeps timing statistics, in Timer1 ticks:
+ *  latency    trigger to interrupt, triggerOnInputCapture() only. Its
+ *             spread is the jitter the interrupt adds.
+ *  interval   from one reading's time to the next. Its spread, jitter(),
+ *             is the trigger source's own jitter with input capture, plus
+ *             the interrupt's with other triggers.
+ *
+ * The interrupt clears the trigger flag (Timer1 input capture, or INT0),
+ * so the next edge triggers again without an interrupt function of its own.
+ *
+ * SIZE must be a power of two, 2 .. 256; it holds SIZE - 1 readings.
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>      // cli()
+#include "ACP_RingBuffer.h"     // _acpLastReading()
+
+typedef struct {
+    uint16_t reading;
+    uint32_t time;              // Timer1 ticks since startTimestamps()
+} ACPStampedReading;
+
+// Internal: Timer1 overflows counted by the library's TIMER1_OVF_vect.
+extern "C" volatile uint16_t _acpTimer1High;
+
+// Internal: a 16-bit Timer1 time taken just now (or a capture a little
+// earlier) as 32 bits, interrupts off. An overflow not yet counted shows
+// as TOV1 still set; it only applies to times after the wrap.
+static inline uint32_t _acpTimer1Ticks(const uint16_t t)
+{
+    uint16_t high = _acpTimer1High;
+    if ((TIFR1 & (1<<TOV1)) && t < 0x8000) high++;
+    return ((uint32_t)high << 16) | t;
+}
+
+template <uint16_t SIZE>
+struct ACPStampedBuffer
+{
+    static_assert(SIZE >= 2 && SIZE <= 256 && (SIZE & (SIZE - 1)) == 0,
+                  "ACPStampedBuffer SIZE must be a power of two, 2 to 256.");
+
+    typedef ACPStampedReading value_type;
+
+    // INTERRUPT SIDE
+
+    // Add a reading and its time. Returns false, and counts an overrun, if
+    // the queue is full.
+    inline bool push(const uint16_t reading, const uint32_t time)
+    {
+        if (_stamps)
+        {
+            uint32_t gap = time - _lastTime;
+            if (gap < _intervalMin) _intervalMin = gap;
+            if (gap > _intervalMax) _intervalMax = gap;
+        }
+        _lastTime = time;
+        if (_stamps != 0xffff) _stamps++;
+
+        uint8_t h = _head, next = (h + 1) & (SIZE - 1);
+        if (next == _tail) {if (_overruns != 0xff) _overruns++; return false;}
+        _data[h].reading = reading;
+        _data[h].time    = time;
+        _head = next;           // publish only after the reading is stored.
+        return true;
+    }
+
+    // LOOP SIDE
+
+    bool    available(void) const {return _head != _tail;}
+    uint8_t count(void) const {return (_head - _tail) & (SIZE - 1);}
+    // Oldest reading and its time. Returns false if there are none.
+    bool pop(ACPStampedReading & r)
+    {
+        uint8_t t = _tail;
+        if (_head == t) return false;
+        r.reading = _data[t].reading;
+        r.time    = _data[t].time;
+        _tail = (t + 1) & (SIZE - 1);   // publish only after the read.
+        return true;
+    }
+    // Readings dropped because the queue was full, up to 255.
+    uint8_t overruns(void) const {return _overruns;}
+
+    // Statistics since streamInto() or clearStats(), Timer1 ticks.
+    uint16_t latencyMin(void)  const {uint8_t s = SREG; cli(); uint16_t v = _latencyMin; SREG = s; return v;}
+    uint16_t latencyMax(void)  const {uint8_t s = SREG; cli(); uint16_t v = _latencyMax; SREG = s; return v;}
+    uint16_t latencyMean(void) const
+    {
+        uint8_t s = SREG; cli(); uint32_t sum = _latencySum; uint16_t n = _latencyCount; SREG = s;
+        return n ? (uint16_t)((sum + n / 2) / n) : 0;
+    }
+    uint32_t intervalMin(void) const {uint8_t s = SREG; cli(); uint32_t v = _intervalMin; SREG = s; return v;}
+    uint32_t intervalMax(void) const {uint8_t s = SREG; cli(); uint32_t v = _intervalMax; SREG = s; return v;}
+    uint32_t jitter(void) const
+    {
+        uint8_t s = SREG; cli(); uint32_t lo = _intervalMin, hi = _intervalMax; SREG = s;
+        return hi >= lo ? hi - lo : 0;
+    }
+    uint16_t stamped(void) const {uint8_t s = SREG; cli(); uint16_t n = _stamps; SREG = s; return n;}
+
+    void clearStats(void)
+    {
+        uint8_t s = SREG; cli();
+        _latencyMin = 0xffff; _latencyMax = 0; _latencySum = 0; _latencyCount = 0;
+        _intervalMin = 0xffffffffUL; _intervalMax = 0; _stamps = 0;
+        SREG = s;
+    }
+
+    // Empty the queue. Stop the readings going in first (stopStreaming()).
+    void clear(void) {_head = 0; _tail = 0; _overruns = 0;}
+
+
+    // Done-interrupt function that timestamps each new reading and pushes
+    // it into this buffer. Use via InternalADC.streamInto(buffer).
+    typedef void (*fillfnptr)();
+    fillfnptr adcFiller(void) {clearStats(); _target = this; return _fillFromADC;}
+
+private:
+    volatile uint8_t  _head = 0;        // written only by the interrupt side
+    volatile uint8_t  _tail = 0;        // written only by loop()
+    volatile uint8_t  _overruns = 0;
+    volatile ACPStampedReading _data[SIZE];
+
+    uint32_t _lastTime = 0;
+    uint16_t _stamps = 0;
+    uint16_t _latencyMin = 0xffff, _latencyMax = 0, _latencyCount = 0;
+    uint32_t _latencySum = 0;
+    uint32_t _intervalMin = 0xffffffffUL, _intervalMax = 0;
+
+    inline void _latency(const uint16_t ticks)
+    {
+        if (ticks < _latencyMin) _latencyMin = ticks;
+        if (ticks > _latencyMax) _latencyMax = ticks;
+        if (_latencyCount != 0xffff) {_latencySum += ticks; _latencyCount++;}
+    }
+
+    static ACPStampedBuffer * volatile _target;
+
+    static void _fillFromADC(void)
+    {
+        uint16_t now = TCNT1, v;
+        _acpLastReading(v);
+        uint32_t time;
+        uint8_t trigger = ADCSRB & 0x07;
+        if (trigger == 0x07)                // input capture: the edge itself
+        {
+            uint16_t edge = ICR1;
+            TIFR1 = (1<<ICF1);
+            time = _acpTimer1Ticks(edge);
+            _target->_latency(now - edge);
+        }
+        else
+        {
+            if (trigger == 0x02) EIFR = (1<<INTF0);
+            time = _acpTimer1Ticks(now);
+        }
+        _target->push(v, time);
+    }
+};
+
+template <uint16_t SIZE>
+ACPStampedBuffer<SIZE> * volatile ACPStampedBuffer<SIZE>::_target = 0;
+
+#endif
@@ -5,6 +5,8 @@
 #include <avr/io.h>         // AVR-libc header files. "*bit_is_*" macros.
 #include <avr/sleep.h>      // for sleepRead()
 #include <util/delay.h>     // for _delay_us().
+#include <avr/eeprom.h>     // calibration
+#include <avr/pgmspace.h>   // temperature sensor curve
 
 
 #include "AnalogControlPanel_M328P.h"
@@ -23,6 +25,85 @@
 //   specialised no-pin readings - internal temperature sensor and
 //     voltage reference, and supply voltage estimate.
 
+// Power state.
+static bool _adcBegun;     // powerOn() done: the registers hold real settings
+static bool _adcCold;      // next conversion is the 25-clock first one
+
+// Reference tracker.
+// The reference takes up to 70 us to settle after it is changed, and so does
+// the bandgap (internal reference) when it comes into use as input. Note
+// when that happens, as a Timer0 count (Timer0 always runs under the Arduino
+// core, 4 us per count), so that reads wait only for what is left of the
+// 70 us, or not at all.
+
+#define BANDGAP_SETTLE_CYCLES (70UL * (F_CPU / 1000000UL))   // 70 us
+
+static bool    _refSettling;   // reference changed, not yet waited for
+static uint8_t _refStamp;      // TCNT0 when it did
+static bool    _bandgapWarm;   // keepBandgapWarm(): bandgap always running
+static uint8_t _warmRefs;      // REFS bits to go back to after that
+
+static inline bool _usesBandgap(const uint8_t admux)
+    {return (admux & 0xc0) == 0xc0 || (admux & 0x0f) == 0x0e;}
+
+// Library changes of reference or of bandgap input go through here.
+static void _setADMUX(const uint8_t admux)
+{
+    uint8_t old = ADMUX;
+    ADMUX = admux;
+    if (((admux ^ old) & 0xc0)
+        || (!_bandgapWarm && _usesBandgap(admux) && !_usesBandgap(old)))
+    {
+        _refStamp    = TCNT0;
+        _refSettling = true;
+    }
+}
+
+// Put back the ADMUX saved before an internal read. Keeping the bandgap
+// warm, keep the read's reference too: the next internal read most likely
+// wants it again.
+static void _restoreADMUX(uint8_t admux)
+{
+    if (_bandgapWarm) admux = (admux & 0x3f) | (ADMUX & 0xc0);
+    _setADMUX(admux);
+}
+
+// Timer0 prescaler 1, 8, 64, 256, 1024 = shift 0, 3, 6, 8, 10: CPU cycles
+// per count. 0xff if Timer0 is stopped or on an external clock.
+static uint8_t _timer0Shift(void)
+{
+    static const uint8_t shifts[6] = {0xff, 0, 3, 6, 8, 10};
+    uint8_t cs = TCCR0B & 0x07;
+    return cs > 5 ? 0xff : shifts[cs];
+}
+
+// Timer0 counts in 70 us, or 0 if Timer0 can't tell: stopped, external
+// clock, more than 255 counts, or not counting straight up to 0xff (CTC
+// with a lower TOP, phase correct PWM), where the count might never get
+// that far ahead.
+static uint8_t _settleCounts(void)
+{
+    uint8_t wgm = (TCCR0A & 0x03) | ((TCCR0B >> 1) & 0x04);
+    if (wgm != 0 && wgm != 3) return 0;     // normal, fast PWM to 0xff only
+    uint8_t shift = _timer0Shift();
+    if (shift == 0xff) return 0;
+    uint32_t counts = (BANDGAP_SETTLE_CYCLES >> shift) + 1;
+    return counts > 255 ? 0 : (uint8_t)counts;
+}
+
+// Wait for what is left of the settling time. Timer0 wraps every 256
+// counts, so after a long time this may wait when it needn't: never longer
+// than the full 70 us, though.
+static void _settleReference(void)
+{
+    if (!_refSettling) return;
+    uint8_t n = _settleCounts();
+    if (n == 0) _delay_us(70);
+    else while ((uint8_t)(TCNT0 - _refStamp) < n) ;
+    _refSettling = false;
+}
+
+
 // Arduino-style begin-end-readAPin functions
 void _M328P_ADC::begin()
 {
@@ -32,6 +113,7 @@ void _M328P_ADC::begin()
     bitDepth10();
     speed1x();
     singleReadingMode();
+    _loadCalibration();
 }
 
 void _M328P_ADC::end() {powerOff();}
@@ -57,6 +139,8 @@ void _M328P_ADC::powerOn()
     ADMUX  = 0x4f;
     // 4=Ref=AVCC, ADLAR = 0,
     // f=Input = internal Gnd
+    _adcBegun = true;
+    _adcCold  = true;
     sei();
 
 }
@@ -72,12 +156,95 @@ void _M328P_ADC::powerOff()
 }
 
 
+// Power sessions.
+// holdPower() .. releasePower() keep the ADC on across any number of reads.
+// If it was off before, it goes off again at the last release, or after
+// powerOffWhenIdle() milliseconds without a session, checked by
+// idlePowerCheck(). Going off this way keeps the settings (and DIDR0): the
+// registers keep their values with the ADC's clock stopped, so waking it
+// is just PRR and ADEN.
+
+// Arduino's millis(), if the sketch has the Arduino core. Weak: 0 if not.
+extern "C" unsigned long millis(void) __attribute__((weak));
+
+static uint8_t       _powerHolds;       // holdPower() calls not yet released
+static bool          _powerWasOff;      // off before the first hold
+static uint16_t      _idleOffMs;        // 0: off at the last release
+static bool          _idleWaiting;      // on only until the idle time is up
+static unsigned long _idleSince;        // millis() at the last release
+
+static void _parkADC(void)
+{
+    cli();
+    ADCSRA |=  (1<<ADIF);
+    ADCSRA &= ~(1<<ADEN);
+    PRR    |= _BV(PRADC);
+    sei();
+}
+
+void _M328P_ADC::holdPower()
+{
+    if (_powerHolds++ != 0) return;
+    if (!_idleWaiting) _powerWasOff = isOff();
+    _idleWaiting = false;
+    if (!isOff()) return;
+    if (!_adcBegun) {begin(); return;}
+    cli();
+    PRR    &= ~_BV(PRADC);
+    ADCSRA |= (1<<ADEN) | (1<<ADIF);
+    _adcCold = true;
+    if (!_bandgapWarm && _usesBandgap(ADMUX))   // it was off with the ADC
+    {
+        _refStamp    = TCNT0;
+        _refSettling = true;
+    }
+    sei();
+    _settleReference();
+}
+
+void _M328P_ADC::releasePower()
+{
+    if (_powerHolds == 0 || --_powerHolds != 0 || !_powerWasOff) return;
+    if (_idleOffMs == 0 || !millis) {_parkADC(); return;}
+    _idleSince   = millis();
+    _idleWaiting = true;
+}
+
+void _M328P_ADC::powerOffWhenIdle(const uint16_t ms) {_idleOffMs = ms;}
+
+bool _M328P_ADC::idlePowerCheck()
+{
+    if (_idleWaiting && (!millis || millis() - _idleSince >= _idleOffMs))
+    {
+        _idleWaiting = false;
+        _parkADC();
+    }
+    return isOn();
+}
+
+bool _M328P_ADC::firstConversionPending() {return isOff() || _adcCold;}
+
+// One conversion, thrown away, so the next reading takes 13 ADC clocks.
+void _M328P_ADC::warmUp()
+{
+    if (isOff() || !_adcCold) return;
+    uint8_t oldADCSRA = ADCSRA;
+    ADCSRA &= ~((1<<ADATE)|(1<<ADIE));
+    loop_until_bit_is_clear(ADCSRA, ADSC);
+    _adcCold = false;
+    ADCSRA |= (1<<ADSC);
+    loop_until_bit_is_clear(ADCSRA, ADSC);
+    ADCSRA = oldADCSRA | (1<<ADIF);
+}
+
+
 void _M328P_ADC::bitDepth8()
 {
     cli();
     ADCSRA &= ~((1<<ADATE)|(1<<ADIE));  //disable autotrigger and interrupts
     ADMUX |= (1<<ADLAR);     //left-adjust: upper 8 bits in ADCH register.
     sei();
+    _osBits = 0;
 }
 
 void _M328P_ADC::bitDepth10()
@@ -86,6 +253,7 @@ void _M328P_ADC::bitDepth10()
     ADCSRA &= ~((1<<ADATE)|(1<<ADIE));  //disable autotrigger and interrupts
     ADMUX &= ~(1<<ADLAR);               // on change of bit depth
     sei();
+    _osBits = 0;
 }
 
 InternalADCSettings _M328P_ADC::saveSettings(void)
@@ -102,7 +270,7 @@ InternalADCSettings _M328P_ADC::saveSettings(void)
 void _M328P_ADC::restoreSettings(InternalADCSettings s)
 {
     cli();
-    ADMUX  = s.admux;
+    _setADMUX(s.admux);
     ADCSRB = s.adcsrb;
     ADCSRA = s.adcsra;
     sei();
@@ -111,58 +279,99 @@ void _M328P_ADC::restoreSettings(InternalADCSettings s)
 void _M328P_ADC::readResolution(const uint8_t bits)
 {
     if (bits == 8) bitDepth8();
+    else if (bits > 10 && bits <= 16) _setOversampling(bits - 10);
     else bitDepth10();
 }
 void _M328P_ADC::readResolution() {bitDepth10();}
 
 
-// internal: translate from desired clock rate to prescaler setting.
-uint8_t _M328P_ADC::_psbitsfromclock(const unsigned long clk)
+// 11 to 16 bits: oversampling and decimation.
+// The readings are summed by the done interrupt; see "Oversampled readings".
+void _M328P_ADC::bitDepth11() {_setOversampling(1);}
+void _M328P_ADC::bitDepth12() {_setOversampling(2);}
+void _M328P_ADC::bitDepth13() {_setOversampling(3);}
+void _M328P_ADC::bitDepth14() {_setOversampling(4);}
+void _M328P_ADC::bitDepth15() {_setOversampling(5);}
+void _M328P_ADC::bitDepth16() {_setOversampling(6);}
+
+void _M328P_ADC::_setOversampling(const uint8_t extraBits)
+{
+    bitDepth10();                              // right-adjusted, full 10 bits
+    _setPrescaler(_acpAccuratePrescaleBits()); // fastest clock <= 200 kHz
+    _osBits = extraBits;
+}
+
+// Dither: Timer2 in CTC mode toggling OC2B (pin 3). One square wave cycle
+// should span the whole set of readings, which takes
+// 13 ADC clocks x 4^bits readings = adcdiv x 13 x 4^bits CPU clocks.
+void _M328P_ADC::ditherOn()
 {
-    uint8_t bits;
-    uint8_t ps = (uint8_t)(F_CPU / clk);
-    // TODO find a log2 function that I understand.
-    switch (ps)
+    uint8_t  bits   = _osBits ? _osBits : 2;
+    uint8_t  adcps  = ADCSRA & 0x07;
+    uint32_t half   = ((13UL << (2 * bits)) << (adcps ? adcps : 1)) / 2;
+    // Timer2 prescaler: 1, 8, 32, 64, 128, 256, 1024 = shift 0,3,5,6,7,8,10.
+    static const uint8_t shifts[7] = {0, 3, 5, 6, 7, 8, 10};
+    uint8_t cs = 0;
+    for (;;)
     {
-        case   2: bits = 0x01; break;
-        case   4: bits = 0x02; break;
-        case   8: bits = 0x03; break;
-        case  16: bits = 0x04; break;
-        case  32: bits = 0x05; break;
-        case  64: bits = 0x06; break;
-        case 128: bits = 0x07; break;
-        default:  bits = 0x07; break;
+        while (cs < 7 && (half >> shifts[cs]) > 256) cs++;
+        if (cs < 7) break;
+        half >>= 1;  // too slow for Timer2: two (four..) cycles per reading.
+        cs = 0;
     }
-    return bits;
+    cli();
+    TCCR2B = 0;                             // stop while changing
+    TCCR2A = (1<<COM2B0) | (1<<WGM21);      // toggle OC2B, CTC mode, TOP OCR2A
+    OCR2A  = (uint8_t)((half >> shifts[cs]) - 1);
+    OCR2B  = 0;
+    TCNT2  = 0;
+    DDRD  |= (1<<DDD3);                     // pin 3 output
+    TCCR2B = cs + 1;                        // CS22..0, start
+    sei();
 }
 
-// Internal: set ADC clock according to desired rate.
-void _M328P_ADC::_setClock(const unsigned long clk)
+void _M328P_ADC::ditherOff()
 {
-    uint8_t psbits = _psbitsfromclock(clk);
     cli();
-    ADCSRA &= 0b11111000;  // all prescale bits off
-    ADCSRA |= (psbits & 0x07);
+    TCCR2B = 0;
+    TCCR2A = 0;
+    DDRD  &= ~(1<<DDD3);
+    sei();
+}
+
+// Internal: prescaler bits for a desired ADC clock rate. The clock functions
+// pass constants, so the compiler does the division and lookup.
+// Ratios the prescaler can't do get the slowest clock, divide by 128.
+#define PSBITS(clk) (_acpPrescaleBits(F_CPU / (clk)) ? \
+                     _acpPrescaleBits(F_CPU / (clk)) : 0x07)
+
+// Internal: set ADC clock prescaler bits.
+void _M328P_ADC::_setPrescaler(const uint8_t psbits)
+{
+    cli();
+    // all prescale bits off and new ones on; write 0 to ADIF so as not to
+    // clear a pending reading.
+    ADCSRA = (ADCSRA & ~((1<<ADIF) | 0x07)) | (psbits & 0x07);
     sei();
 }
 
 // visible functions
-void _M328P_ADC::clock1M(void)   {_setClock(1000000UL);}
-void _M328P_ADC::clock500k(void) {_setClock( 500000UL);}
-void _M328P_ADC::clock250k(void) {_setClock( 250000UL);}
-void _M328P_ADC::clock125k(void) {_setClock( 125000UL);}
-void _M328P_ADC::clock62k5(void) {_setClock(  62500UL);}
+void _M328P_ADC::clock1M(void)   {_setPrescaler(PSBITS(1000000UL));}
+void _M328P_ADC::clock500k(void) {_setPrescaler(PSBITS( 500000UL));}
+void _M328P_ADC::clock250k(void) {_setPrescaler(PSBITS( 250000UL));}
+void _M328P_ADC::clock125k(void) {_setPrescaler(PSBITS( 125000UL));}
+void _M328P_ADC::clock62k5(void) {_setPrescaler(PSBITS(  62500UL));}
 
-void _M328P_ADC::rate75k(void)   {_setClock(1000000UL);} // ADC clock 1MHz.OK for 8bit maybe.
-void _M328P_ADC::rate37k(void)   {_setClock( 500000UL);} // OK-ish for 10bit
-void _M328P_ADC::rate18k(void)   {_setClock( 250000UL);} // Fine
-void _M328P_ADC::rate9k(void)    {_setClock( 125000UL);} // Fine, lowest with 16MHz sys clock.
-void _M328P_ADC::rate4k(void)    {_setClock(  62500UL);} // Better with 1MHz clock?
+void _M328P_ADC::rate75k(void)   {_setPrescaler(PSBITS(1000000UL));} // ADC clock 1MHz.OK for 8bit maybe.
+void _M328P_ADC::rate37k(void)   {_setPrescaler(PSBITS( 500000UL));} // OK-ish for 10bit
+void _M328P_ADC::rate18k(void)   {_setPrescaler(PSBITS( 250000UL));} // Fine
+void _M328P_ADC::rate9k(void)    {_setPrescaler(PSBITS( 125000UL));} // Fine, lowest with 16MHz sys clock.
+void _M328P_ADC::rate4k(void)    {_setPrescaler(PSBITS(  62500UL));} // Better with 1MHz clock?
 
-void _M328P_ADC::speed1x(void)   {_setClock( 125000UL);} // Arduino compatible functions.
-void _M328P_ADC::speed2x(void)   {_setClock( 250000UL);}
-void _M328P_ADC::speed4x(void)   {_setClock( 500000UL);}
-void _M328P_ADC::speed8x(void)   {_setClock(1000000UL);}
+void _M328P_ADC::speed1x(void)   {_setPrescaler(PSBITS( 125000UL));} // Arduino compatible functions.
+void _M328P_ADC::speed2x(void)   {_setPrescaler(PSBITS( 250000UL));}
+void _M328P_ADC::speed4x(void)   {_setPrescaler(PSBITS( 500000UL));}
+void _M328P_ADC::speed8x(void)   {_setPrescaler(PSBITS(1000000UL));}
 
 
 
@@ -182,10 +391,11 @@ void _M328P_ADC::reference(const int ref)
 void _M328P_ADC::reference() {reference(DEFAULT);}
 
 // Default = supply voltage is maximum/reference.
+// A change of reference settles, as for the internal one.
 void _M328P_ADC::referenceDefault()
 {
-    ADMUX &= ~(1<<REFS1);   // ref selection = 01.
-    ADMUX |=  (1<<REFS0);
+    _setADMUX((ADMUX & ~(1<<REFS1)) | (1<<REFS0));  // ref selection = 01.
+    _settleReference();
 }
 
 /* Internal bandgap reference, nominal 1.1V.
@@ -194,17 +404,43 @@ void _M328P_ADC::referenceDefault()
     */
 void _M328P_ADC::referenceInternal()
 {
-    ADMUX |= (1<<REFS0) | (1<<REFS1);  // ref bits 11
-    _delay_us(70);                     // stabilise internal BG ref.
+    _setADMUX(ADMUX | (1<<REFS0) | (1<<REFS1));  // ref bits 11
+    _settleReference();                          // stabilise internal BG ref.
 }
 
-void _M328P_ADC::setInternalReferenceVoltage(float newV){bandgapV = newV;}
+// Keep the bandgap running (comparator bandgap select, ACBG), and leave the
+// internal reads' reference selected between them, until releaseBandgap().
+void _M328P_ADC::keepBandgapWarm()
+{
+    if (_bandgapWarm) return;
+    ACSR |= (1<<ACBG);
+    if (!(isOn() && _usesBandgap(ADMUX)))
+    {
+        _refStamp    = TCNT0;       // may have been off: give it its time.
+        _refSettling = true;
+    }
+    _warmRefs    = ADMUX & 0xc0;
+    _bandgapWarm = true;
+}
+
+void _M328P_ADC::releaseBandgap()
+{
+    if (!_bandgapWarm) return;
+    _bandgapWarm = false;
+    ACSR &= ~(1<<ACBG);
+    _setADMUX((ADMUX & 0x3f) | _warmRefs);
+}
+
+void _M328P_ADC::setInternalReferenceVoltage(float newV)
+    {_bandgapmV = (uint16_t)(newV * 1000.0 + 0.5);}
+void _M328P_ADC::setInternalReferenceMillivolts(uint16_t mV) {_bandgapmV = mV;}
+uint16_t _M328P_ADC::internalReferenceMillivolts() {return _bandgapmV;}
 
 /* External voltage reference IC on AREF pin, e.g. a TL431 or LM4040.*/
 void _M328P_ADC::referenceExternal()
 {
-    ADMUX &= ~(1<<REFS1);  // ref bits 00.
-    ADMUX &= ~(1<<REFS0);
+    _setADMUX(ADMUX & ~((1<<REFS1) | (1<<REFS0)));  // ref bits 00.
+    _settleReference();
 }
 
 void _M328P_ADC::setScale( const int ref)
@@ -349,6 +585,199 @@ void _M328P_ADC::triggerOnTimer1Overflow()
     sei();
 }
 
+// Configuration changes.
+// Setters work on the copy only. commit() stops auto triggering first, so
+// nothing starts a conversion halfway, then writes ADMUX, ADCSRB and DIDR0,
+// and ADCSRA last, as ACPConfig::apply() does. ADIF and ADSC are kept out
+// of the copy: committing neither clears a pending reading nor starts one.
+
+#define ADCSRA_KEEP (uint8_t)~((1<<ADIF) | (1<<ADSC))
+
+ACPConfigChange::ACPConfigChange()
+{
+    shadow.adcsra = ADCSRA & ADCSRA_KEEP;
+    shadow.adcsrb = ADCSRB;
+    shadow.admux  = ADMUX;
+    didr0         = DIDR0;
+}
+
+ACPConfigChange::ACPConfigChange(const InternalADCSettings s) : shadow(s)
+{
+    shadow.adcsra &= ADCSRA_KEEP;
+    didr0 = DIDR0;
+}
+
+void ACPConfigChange::usePin(uint8_t pin)
+{
+    if (pin > 13) pin -= 14;
+    shadow.admux = (shadow.admux & 0xf0) | (pin & 0x07);
+    if (pin < 6) didr0 |= (1 << pin);
+}
+
+void ACPConfigChange::freePin(uint8_t pin)
+{
+    if (pin > 13) pin -= 14;
+    shadow.admux |= 0x0f;
+    if (pin < 6) didr0 &= ~(1 << pin);
+}
+
+void ACPConfigChange::reference(const int ref)
+{
+    if (ref == ACP_REF_INTERNAL)      referenceInternal();
+    else if (ref == ACP_REF_EXTERNAL) referenceExternal();
+    else                              referenceDefault();
+}
+void ACPConfigChange::referenceDefault()  {shadow.admux = (shadow.admux & 0x3f) | (1<<REFS0);}
+void ACPConfigChange::referenceInternal() {shadow.admux |= (1<<REFS1) | (1<<REFS0);}
+void ACPConfigChange::referenceExternal() {shadow.admux &= 0x3f;}
+
+void ACPConfigChange::bitDepth8()  {shadow.admux |=  (1<<ADLAR);}
+void ACPConfigChange::bitDepth10() {shadow.admux &= ~(1<<ADLAR);}
+
+void ACPConfigChange::speed1x() {shadow.adcsra = (shadow.adcsra & ~0x07) | PSBITS( 125000UL);}
+void ACPConfigChange::speed2x() {shadow.adcsra = (shadow.adcsra & ~0x07) | PSBITS( 250000UL);}
+void ACPConfigChange::speed4x() {shadow.adcsra = (shadow.adcsra & ~0x07) | PSBITS( 500000UL);}
+void ACPConfigChange::speed8x() {shadow.adcsra = (shadow.adcsra & ~0x07) | PSBITS(1000000UL);}
+
+void ACPConfigChange::singleReadingMode() {shadow.adcsra &= ~(1<<ADATE);}
+
+void ACPConfigChange::_trigger(const uint8_t source)
+{
+    shadow.adcsrb  = source;
+    shadow.adcsra |= (1<<ADATE);
+}
+void ACPConfigChange::freeRunningMode()         {_trigger(0x00);}
+void ACPConfigChange::triggerOnInterrupt0()     {_trigger(0x02);}
+void ACPConfigChange::triggerOnTimer0Overflow() {_trigger(0x04);}
+void ACPConfigChange::triggerOnTimer1CompareB() {_trigger(0x05);}
+void ACPConfigChange::triggerOnTimer1Overflow() {_trigger(0x06);}
+void ACPConfigChange::triggerOnInputCapture()   {_trigger(0x07);}
+
+void ACPConfigChange::interruptOnDone()   {shadow.adcsra |=  (1<<ADIE);}
+void ACPConfigChange::noInterruptOnDone() {shadow.adcsra &= ~(1<<ADIE);}
+
+void ACPConfigChange::commit()
+{
+    cli();
+    ADCSRA &= ~((1<<ADATE) | (1<<ADIF));
+    _setADMUX(shadow.admux);
+    ADCSRB = shadow.adcsrb;
+    DIDR0  = didr0;
+    ADCSRA = shadow.adcsra;
+    sei();
+}
+
+
+// Exact sample rates from Timer1.
+// Timer1 counts up to OCR1A and starts again from zero (CTC mode 4). OCR1B is
+// set to the same value, so compare match B sets OCF1B at the same moment
+// and the rising flag starts a conversion. The compare B interrupt (see
+// ACP_M328P_interrupt.h) clears the flag ready for next time.
+
+static unsigned long _sampleInterval;   // CPU clocks per reading
+
+unsigned long _M328P_ADC::sampleAt(const unsigned long hz)
+{
+    if (hz == 0) return 0;
+    // An auto-triggered conversion takes 13.5 ADC clocks, plus up to one
+    // more to synchronise with the trigger: allow 14.
+    uint8_t       adcps  = ADCSRA & 0x07;
+    unsigned long adcdiv = 1UL << (adcps ? adcps : 1);
+    unsigned long counts = (F_CPU + hz / 2) / hz;
+    if (counts < 14 * adcdiv) return 0;
+    // Another library's TIMER1_COMPB_vect replaced the library's: Timer1 is
+    // theirs.
+    if (&TIMER1_COMPB_vect != &__vector_acpTimer1CompB) return 0;
+
+    // Timer1 prescaler 1, 8, 64, 256, 1024 = shift 0, 3, 6, 8, 10.
+    static const uint8_t shifts[5] = {0, 3, 6, 8, 10};
+    uint8_t cs = 0;
+    while (cs < 4 && ((counts + (1UL << shifts[cs]) / 2) >> shifts[cs]) > 65536UL)
+        cs++;
+    unsigned long ticks = (counts + (1UL << shifts[cs]) / 2) >> shifts[cs];
+    if (ticks > 65536UL) ticks = 65536UL;   // slowest possible
+    if (ticks < 1) ticks = 1;
+    uint16_t top = (uint16_t)(ticks - 1);
+    _sampleInterval = ticks << shifts[cs];
+
+    cli();
+    TCCR1B = 0;                             // stop Timer1 while changing it
+    TCCR1A = 0;                             // no output pins
+    TCNT1  = 0;
+    OCR1A  = top;
+    OCR1B  = top;
+    TIFR1  = (1<<OCF1B);                    // clear flag: next match triggers
+    TIMSK1 |= (1<<OCIE1B);
+    ADCSRB = 0x05;                          // trigger source 5 = "Timer1 compare match B".
+    ADCSRA = (ADCSRA & ~(1<<ADIF)) | (1<<ADATE);
+    TCCR1B = (1<<WGM12) | (cs + 1);         // CTC mode 4, start counting
+    sei();
+
+    return (F_CPU + _sampleInterval / 2) / _sampleInterval;
+}
+
+unsigned long _M328P_ADC::sampleInterval() {return _sampleInterval;}
+
+void _M328P_ADC::stopSampling()
+{
+    cli();
+    TCCR1B  = 0;
+    TIMSK1 &= ~(1<<OCIE1B);
+    TIFR1   = (1<<OCF1B);
+    ADCSRA  = ADCSRA & ~((1<<ADIF) | (1<<ADATE));
+    ADCSRB  = 0;
+    sei();
+    loop_until_bit_is_clear(ADCSRA, ADSC);  // a triggered reading may be under way
+    ADCSRA |= (1<<ADIF);
+}
+
+
+// Timestamps. Timer1 in normal mode, counting 0..0xffff; each overflow
+// interrupt adds one to the top 16 bits (ACP_M328P_interrupt.h).
+unsigned long _M328P_ADC::startTimestamps(const uint16_t prescale)
+{
+    uint8_t cs;
+    switch (prescale)
+    {
+        case 1:    cs = 1; break;
+        case 8:    cs = 2; break;
+        case 64:   cs = 3; break;
+        case 256:  cs = 4; break;
+        case 1024: cs = 5; break;
+        default:   return 0;
+    }
+    // Another library's TIMER1_OVF_vect: no top 16 bits.
+    if (&TIMER1_OVF_vect != &__vector_acpTimer1Ovf) return 0;
+    cli();
+    TCCR1B = 0;                             // stop Timer1 while changing it
+    TCCR1A = 0;                             // normal mode, no output pins
+    TCNT1  = 0;
+    _acpTimer1High = 0;
+    TIFR1  = (1<<TOV1) | (1<<ICF1);
+    TIMSK1 = (TIMSK1 & ~(1<<OCIE1B)) | (1<<TOIE1);
+    TCCR1B = (1<<ICNC1) | (1<<ICES1) | cs;  // capture rising edges, filtered
+    sei();
+    return F_CPU / prescale;
+}
+
+unsigned long _M328P_ADC::timestampNow()
+{
+    cli();
+    unsigned long t = _acpTimer1Ticks(TCNT1);
+    sei();
+    return t;
+}
+
+void _M328P_ADC::stopTimestamps()
+{
+    cli();
+    TCCR1B  = 0;
+    TIMSK1 &= ~(1<<TOIE1);
+    TIFR1   = (1<<TOV1);
+    sei();
+}
+
+
 // SIGNALING: NOTIFICATION OF COMPLETION
 // =====================================
 
@@ -374,6 +803,110 @@ void _M328P_ADC::detachDoneInterruptFunction()
 //{_ADCDoneFunc = _ADCdefaultISR;}
 {_ADCDoneFunc = 0;}
 
+// Queue readings for loop(): streamInto(buffer) is in the header (template).
+void _M328P_ADC::stopStreaming()
+{
+    noInterruptOnDone();
+    detachDoneInterruptFunction();
+}
+
+// Acquisition counters.
+#ifdef ACP_INSTRUMENT
+
+static ACPCounters      _counts;
+static volatile uint8_t _countStarted;   // triggered readings not yet in
+static bool             _countUnread;    // a reading waits for getLastReading()
+static uint8_t          _countTimer0;    // TCNT0 at the last reading
+static bool             _countTimed;     // _countTimer0 is set
+
+static inline void _countOverwritten(const uint8_t n)
+{
+    uint16_t v = _counts.overwritten + n;
+    _counts.overwritten = (v < n) ? 0xffff : v;
+}
+
+// A reading came in: for the sketch to collect with getLastReading(), or
+// not (a done function takes it). Free running, the time since the last one
+// says how many came in between: Timer0 counts, if a reading is 4 or more.
+extern "C" void _acpCountReading(const bool forSketch)
+{
+    _counts.conversions++;
+    uint8_t started = _countStarted;
+    _countStarted = 0;
+    if ((ADCSRA & (1<<ADATE)) && (ADCSRB & 0x07) == 0)
+    {
+        uint8_t shift = _timer0Shift(), now = TCNT0;
+        uint8_t ps = ADCSRA & 0x07;
+        uint16_t period = (shift == 0xff) ? 0 : (13U << (ps ? ps : 1)) >> shift;
+        if (period >= 4 && period < 256 && _countTimed)
+            started = ((uint8_t)(now - _countTimer0) + period / 2) / period;
+        _countTimer0 = now;
+        _countTimed  = true;
+    }
+    if (started > 1) _countOverwritten(started - 1);
+    if (forSketch)
+    {
+        if (_countUnread) _countOverwritten(1);
+        _countUnread = true;
+    }
+}
+
+// Timer1 ticks since start, as CPU cycles. Only counting up: normal mode,
+// or CTC (sampleAt()), which wraps round early.
+extern "C" void _acpCountInterruptTime(const uint16_t start)
+{
+    uint16_t end = TCNT1;
+    static const uint8_t shifts[6] = {0xff, 0, 3, 6, 8, 10};
+    uint8_t cs = TCCR1B & 0x07, wgm = TCCR1B & ((1<<WGM13) | (1<<WGM12));
+    if (cs == 0 || cs > 5 || (TCCR1A & 0x03) || wgm == (1<<WGM13)) return;
+    uint16_t ticks = end - start;
+    if (end < start && wgm) ticks += ((wgm & (1<<WGM13)) ? ICR1 : OCR1A) + 1;
+    uint32_t cycles = (uint32_t)ticks << shifts[cs];
+    if (cycles > 0xffff) cycles = 0xffff;
+    if (cycles > _counts.longestDone) _counts.longestDone = (uint16_t)cycles;
+}
+
+// A trigger came. If the reading started by the one before isn't in yet,
+// the ADC is still busy with it and this one is lost.
+extern "C" void _acpCountTrigger(void)
+{
+    if (bit_is_clear(ADCSRA, ADATE)) return;
+    if (_countStarted && bit_is_clear(ADCSRA, ADIF))
+    {
+        if (_counts.triggersLost != 0xffff) _counts.triggersLost++;
+    }
+    else if (_countStarted != 0xff) _countStarted++;
+}
+
+ACPCounters _M328P_ADC::counters()
+{
+    cli();
+    ACPCounters c = _counts;
+    sei();
+    return c;
+}
+
+void _M328P_ADC::clearCounters()
+{
+    cli();
+    _counts.conversions = 0; _counts.overwritten = 0;
+    _counts.triggersLost = 0; _counts.longestDone = 0;
+    _countStarted = 0; _countUnread = false; _countTimed = false;
+    sei();
+}
+
+// From the sketch's own interrupt function: keep interrupts off there.
+void _M328P_ADC::countTrigger()
+    {uint8_t s = SREG; cli(); _acpCountTrigger(); SREG = s;}
+
+#else
+
+ACPCounters _M328P_ADC::counters() {ACPCounters c = {0, 0, 0, 0}; return c;}
+void _M328P_ADC::clearCounters() {}
+void _M328P_ADC::countTrigger()  {}
+
+#endif
+
 // How to see if the ADC is finished.
 bool _M328P_ADC::readingReady()
 {
@@ -384,6 +917,9 @@ bool _M328P_ADC::readingReady()
     {
         bool done = bit_is_set(ADCSRA, ADIF); // ADC done when IF set.
         if  (done) {ADCSRA |= (1<<ADIF);}  // clear IF ready for next sample
+#ifdef ACP_INSTRUMENT
+        if  (done) {cli(); _acpCountReading(true); sei();}
+#endif
 
         return done;    // true if ADC finished.
     }
@@ -407,10 +943,19 @@ bool _M328P_ADC::readingReady()
 
 int _M328P_ADC::getLastReading(void)
 {
+#ifdef ACP_INSTRUMENT
+    _countUnread = false;
+#endif
     if (bit_is_set(ADMUX, ADLAR)) return (int)ADCH; // 8-bit mode
     return (int)ADC;
 }
-uint8_t _M328P_ADC::getLastReading8Bit() {return ADCH;}
+uint8_t _M328P_ADC::getLastReading8Bit()
+{
+#ifdef ACP_INSTRUMENT
+    _countUnread = false;
+#endif
+    return ADCH;
+}
 
 /*
     * Blocking Reads.
@@ -418,19 +963,21 @@ uint8_t _M328P_ADC::getLastReading8Bit() {return ADCH;}
     */
 
 // Like Arduino's analogRead() function.
+// If the ADC is off, it is on for just this reading (see Power sessions).
 int _M328P_ADC::analogRead(const uint8_t pin)
 {
+    holdPower();
     uint8_t oldADCSRA = ADCSRA, oldADMUX  = ADMUX;
-    bool wasOff = isOff();
-    if (wasOff) begin();
     singleReadingMode();
     usePin(pin);
+    _adcCold = false;
     ADCSRA |= (1<<ADSC);
     loop_until_bit_is_clear(ADCSRA, ADSC);
     freePin(pin);
     ADMUX = oldADMUX; ADCSRA = oldADCSRA;
-    if (wasOff) end();
-    return getLastReading();
+    int reading = getLastReading();
+    releasePower();
+    return reading;
 }
 
 // Use 'usePin()' before using the bare read().
@@ -440,6 +987,7 @@ int _M328P_ADC::read(void)
 {
     uint8_t oldADCSRA = ADCSRA, oldADMUX  = ADMUX;
     singleReadingMode();       // disable event-based triggering
+    _adcCold = false;
     ADCSRA |= (1<<ADSC);
     loop_until_bit_is_clear(ADCSRA, ADSC);
     ADMUX = oldADMUX; ADCSRA = oldADCSRA;
@@ -453,10 +1001,12 @@ uint8_t _M328P_ADC::read8Bit(void)
     uint8_t oldADCSRA = ADCSRA, oldADMUX  = ADMUX;
     ADMUX  |= (1<<ADLAR);
     singleReadingMode();
+    _adcCold = false;
     ADCSRA |= (1<<ADSC);
     loop_until_bit_is_clear(ADCSRA, ADSC);
+    uint8_t reading = ADCH;     // before ADLAR goes back: it applies at once
     ADMUX = oldADMUX; ADCSRA = oldADCSRA;
-    return ADCH;
+    return reading;
 }
 
 
@@ -473,6 +1023,7 @@ int _M328P_ADC::sleepRead(void)
     singleReadingMode();               // clear auto-trigger flag
     cli();
     set_sleep_mode(SLEEP_MODE_ADC);
+    _adcCold = false;
     ADCSRA |= (1<<ADSC) | (1<<ADIE); // enable ADC interrupt to wake CPU.
     sleep_enable();
     sei();
@@ -484,9 +1035,68 @@ int _M328P_ADC::sleepRead(void)
     cli();
     loop_until_bit_is_clear(ADCSRA, ADSC);
     ADMUX = oldADMUX; ADCSRA = oldADCSRA;
+    sei();
     return getLastReading();
 }
 
+// Several readings, one sleep each, added up by the done interrupt. Going
+// into ADC sleep with the ADC idle starts a conversion, so there is nothing
+// to set up between readings: sleep, add, sleep again. The count is checked
+// with interrupts off, and sei() lets sleep_cpu() run before any interrupt,
+// so no conversion is started after the last one.
+
+static volatile uint16_t _slCount;      // readings still to take
+static volatile uint32_t _slSum;
+static volatile uint16_t _slMin, _slMax;
+static voidfnptr         _slSavedFunc;  // user's done function, if any
+
+static void _sleepManyISR(void)
+{
+    if (_slCount == 0) return;
+    uint16_t v = ADC;
+    _slSum += v;
+    if (v < _slMin) _slMin = v;
+    if (v > _slMax) _slMax = v;
+    _slCount--;
+}
+
+unsigned long _M328P_ADC::sleepReadSum(const uint16_t n)
+{
+    if (n == 0 || isOff()) return 0;
+    uint8_t oldADCSRA = ADCSRA, oldADMUX = ADMUX;
+    ADCSRA &= ~((1<<ADATE)|(1<<ADIE));
+    loop_until_bit_is_clear(ADCSRA, ADSC);
+    ADMUX  &= ~(1<<ADLAR);             // 10 bits
+    cli();
+    _slCount = n; _slSum = 0; _slMin = 0xffff; _slMax = 0;
+    _slSavedFunc = _ADCDoneFunc;
+    _ADCDoneFunc = _sleepManyISR;
+    ADCSRA |= (1<<ADIF);
+    ADCSRA |= (1<<ADIE);               // ADC interrupt wakes the CPU.
+    set_sleep_mode(SLEEP_MODE_ADC);
+    _adcCold = false;
+    while (_slCount)
+    {
+        // Woken by some other interrupt mid-conversion: sleep again, the
+        // conversion carries on (no new one starts).
+        sleep_enable();
+        sei();
+        sleep_cpu();
+        sleep_disable();
+        cli();
+    }
+    _ADCDoneFunc = _slSavedFunc;
+    ADMUX = oldADMUX; ADCSRA = oldADCSRA;
+    sei();
+    return _slSum;
+}
+
+int _M328P_ADC::sleepReadAverage(const uint16_t n)
+    {return n ? (int)((sleepReadSum(n) + n / 2) / n) : 0;}
+
+int _M328P_ADC::sleepReadMin() {return _slMin;}
+int _M328P_ADC::sleepReadMax() {return _slMax;}
+
 // Non-Blocking Sampling.
 
 // The cycle is:
@@ -495,12 +1105,665 @@ int _M328P_ADC::sleepRead(void)
 // In interrupt-triggered modes don't use StartSample().
 // (triggerOnInterrupt0(), etc.)
 
-void _M328P_ADC::startReading() {_adcdone = false; ADCSRA |= (1<<ADSC);}
+void _M328P_ADC::startReading() {_adcdone = false; _adcCold = false; ADCSRA |= (1<<ADSC);}
 // startReading() not needed except in singleShot and freeRunning modes.
 // For the others, an event (external interrupt, etc.) will start the ADC.
 
 
 
+// Burst capture.
+// Free running, polling ADIF: no save-start-wait-restore per reading, so the
+// readings are exactly 13 ADC clocks apart as long as the loop keeps up.
+// Timer0 is read once per reading (Arduino's millis() timer: it runs
+// anyway) to time the burst, so a reading missed to an interrupt shows up
+// as a longer period.
+
+template <typename T>
+static void _burstLoop(T * buffer, const uint16_t n, uint16_t & wraps,
+                       uint8_t & first, uint8_t & last)
+{
+    uint8_t t = 0, prev = 0;
+    wraps = 0;
+    for (uint16_t i = 0; i < n; i++)
+    {
+        loop_until_bit_is_set(ADCSRA, ADIF);
+        t = TCNT0;
+        ADCSRA |= (1<<ADIF);               // clear the flag: write a 1.
+        buffer[i] = (sizeof(T) == 1) ? (T)ADCH : (T)ADC;
+        if (i == 0) first = t;
+        else if (t < prev) wraps++;
+        prev = t;
+    }
+    last = t;
+}
+
+static unsigned long _burstPeriod;     // CPU clocks per reading, last burst
+
+template <typename T>
+static unsigned long _burst(T * buffer, const uint16_t n, const bool interruptsOff)
+{
+    if (n == 0) return 0;
+    uint8_t oldADCSRA = ADCSRA, oldADCSRB = ADCSRB, oldADMUX = ADMUX;
+    ADCSRA &= ~((1<<ADATE)|(1<<ADIE));
+    loop_until_bit_is_clear(ADCSRA, ADSC);
+    if (sizeof(T) == 1) ADMUX |= (1<<ADLAR);
+    else                ADMUX &= ~(1<<ADLAR);
+    ADCSRB  = 0x00;                        // free running
+    ADCSRA |= (1<<ADIF);
+
+    uint16_t wraps;
+    uint8_t  first = 0, last = 0;
+    _adcCold = false;
+    if (interruptsOff) cli();
+    ADCSRA |= (1<<ADATE) | (1<<ADSC);
+    _burstLoop(buffer, n, wraps, first, last);
+    if (interruptsOff) sei();
+
+    ADCSRA &= ~(1<<ADATE);
+    loop_until_bit_is_clear(ADCSRA, ADSC);
+    ADCSRA |= (1<<ADIF);
+    ADMUX = oldADMUX; ADCSRB = oldADCSRB; ADCSRA = oldADCSRA;
+
+    // Nominal period, unless the burst took at least one reading longer
+    // than it should. Without Timer0, or if it wraps faster than the ADC
+    // converts, the nominal period is all there is.
+    uint8_t       ps      = oldADCSRA & 0x07;
+    unsigned long nominal = 13UL << (ps ? ps : 1);
+    _burstPeriod = nominal;
+    uint8_t shift = _timer0Shift();
+    if (n > 1 && shift != 0xff && (256UL << shift) > nominal)
+    {
+        unsigned long elapsed = ((((unsigned long)wraps << 8) + last) - first) << shift;
+        unsigned long due     = nominal * (n - 1);
+        if (elapsed >= due + nominal + (1UL << shift))
+            _burstPeriod = (elapsed + (n - 1) / 2) / (n - 1);
+    }
+    return _burstPeriod;
+}
+
+unsigned long _M328P_ADC::readBurst(uint8_t * buffer, const uint16_t n,
+                                    const bool interruptsOff)
+    {return _burst(buffer, n, interruptsOff);}
+
+unsigned long _M328P_ADC::readBurst(int * buffer, const uint16_t n,
+                                    const bool interruptsOff)
+    {return _burst(buffer, n, interruptsOff);}
+
+unsigned long _M328P_ADC::burstPeriod() {return _burstPeriod;}
+
+
+// Auto-tuning
+// ===========
+// Every combination is measured, so the choice doesn't depend on the order.
+// Faster first: speed4x before speed2x before speed1x, and at each speed
+// free running (13 ADC clocks a reading) before read() (a little over 13,
+// and the loop's time to start each one). Readings at 0 or 1023 are
+// clipped, so their scatter means nothing: those candidates don't count.
+
+static float _tuneScatter = -1.0;
+
+// Free running, polling ADIF as for bursts; the first two readings after
+// the start are not kept.
+static void _tuneFreeRun(ACPStats<> & stats, const uint16_t n)
+{
+    ADCSRB  = 0x00;
+    ADCSRA |= (1<<ADIF);
+    _adcCold = false;
+    ADCSRA |= (1<<ADATE) | (1<<ADSC);
+    for (uint16_t i = 0; i < n + 2; i++)
+    {
+        loop_until_bit_is_set(ADCSRA, ADIF);
+        ADCSRA |= (1<<ADIF);
+        uint16_t v = ADC;
+        if (i >= 2) stats.push(v);
+    }
+    ADCSRA &= ~(1<<ADATE);
+    loop_until_bit_is_clear(ADCSRA, ADSC);
+    ADCSRA |= (1<<ADIF);
+}
+
+InternalADCSettings _M328P_ADC::autoTune(const uint8_t pin, const float maxScatter,
+                                         const uint16_t n)
+{
+    holdPower();
+    InternalADCSettings start = saveSettings(), best = start;
+    uint8_t oldDIDR0 = DIDR0;                   // usePin() changes it
+    uint8_t bestRank = 0xff;                    // 0xff: none met maxScatter
+    float   bestScatter = -1.0;
+
+    cli();
+    ADCSRA &= ~((1<<ADATE)|(1<<ADIE));
+    sei();
+    loop_until_bit_is_clear(ADCSRA, ADSC);
+    ADMUX &= ~(1<<ADLAR);                       // 10-bit
+    usePin(pin);
+
+    // The sketch's own reference last, so it is settled again at the end.
+    bool internalLast = (start.admux & ((1<<REFS1)|(1<<REFS0))) == ((1<<REFS1)|(1<<REFS0));
+    for (uint8_t ref = 0; ref < 2; ref++)
+    {
+        if ((ref == 1) == internalLast) referenceInternal(); else referenceDefault();
+        // AREF has a capacitor on most boards: give it time to get there.
+        speed1x();
+        for (uint8_t i = 0; i < 200; i++) read();
+
+        for (uint8_t rank = 0; rank < 6; rank++)
+        {
+            uint8_t speed = rank >> 1;              // 0: 4x, 1: 2x, 2: 1x
+            bool    freeRun = !(rank & 1);
+            if (speed == 0) speed4x(); else if (speed == 1) speed2x(); else speed1x();
+
+            ACPStats<> stats;
+            if (freeRun) _tuneFreeRun(stats, n);
+            else
+            {
+                read(); read();                     // settle at this speed
+                for (uint16_t i = 0; i < n; i++) stats.push(read());
+            }
+            ACPStats<>::Summary s = stats.summary();
+            if (s.count == 0 || s.min == 0 || s.max >= 1023) continue;
+            float scatter = s.stddev();
+
+            bool better;
+            if (scatter <= maxScatter)
+                better = rank < bestRank || (rank == bestRank && scatter < bestScatter);
+            else
+                better = bestRank == 0xff && (bestScatter < 0.0 || scatter < bestScatter);
+            if (!better) continue;
+
+            if (scatter <= maxScatter) bestRank = rank;
+            bestScatter = scatter;
+            best.admux  = (start.admux & (1<<ADLAR)) | (ADMUX & ~(1<<ADLAR));
+            best.adcsra = (start.adcsra & ~((1<<ADATE)|(1<<ADIF)|(1<<ADSC)|0x07))
+                          | (ADCSRA & 0x07) | (freeRun ? (1<<ADATE) : 0);
+            best.adcsrb = start.adcsrb & ~0x07;     // free running, if ADATE
+        }
+    }
+
+    restoreSettings(start);
+    DIDR0 = oldDIDR0;
+    releasePower();
+    _tuneScatter = bestScatter;
+    return best;
+}
+
+float _M328P_ADC::tunedScatter() {return _tuneScatter;}
+
+
+// Oversampled readings
+// ====================
+
+// Free running, the done interrupt adds up 4^bits readings then stops the
+// ADC. Up to 16 readings (12 bits) fit in 16 bits; more need a long.
+
+static volatile uint16_t _osCount;       // readings still to add up
+static volatile uint16_t _osSum16;
+static volatile uint32_t _osSum32;
+static volatile bool     _osDone;
+static voidfnptr         _osSavedFunc;   // user's done function, if any
+
+static inline void _osFinish(void)
+{
+    ADCSRA &= ~((1<<ADATE)|(1<<ADIE));   // stop free running and interrupts
+    _ADCDoneFunc = _osSavedFunc;
+    _osDone = true;
+}
+
+static void _os16ISR(void) {_osSum16 += ADC; if (--_osCount == 0) _osFinish();}
+static void _os32ISR(void) {_osSum32 += ADC; if (--_osCount == 0) _osFinish();}
+
+// Refuses without a bit depth from bitDepth11() .. bitDepth16().
+bool _M328P_ADC::startOversampledReading()
+{
+    if (_osBits == 0) return false;
+    cli();
+    ADCSRA &= ~((1<<ADATE)|(1<<ADIE));
+    loop_until_bit_is_clear(ADCSRA, ADSC);
+    _osCount = 1U << (2 * _osBits);
+    _osSum16 = 0; _osSum32 = 0;
+    _osDone  = false;
+    _osSavedFunc = _ADCDoneFunc;
+    _ADCDoneFunc = (_osBits > 2) ? _os32ISR : _os16ISR;
+    ADCSRB  = 0x00;                       // free running
+    ADCSRA |= (1<<ADIF);
+    _adcCold = false;
+    ADCSRA |= (1<<ADATE) | (1<<ADIE) | (1<<ADSC);
+    sei();
+    return true;
+}
+
+bool _M328P_ADC::oversampledReady() {return _osDone;}
+
+// Decimate: divide the sum by 2^bits, rounded.
+long _M328P_ADC::getOversampledReading()
+{
+    uint8_t n = _osBits ? _osBits : 2;
+    if (_osDone)        // free running had started one more: let it finish
+    {
+        loop_until_bit_is_clear(ADCSRA, ADSC);
+        ADCSRA |= (1<<ADIF);
+    }
+    cli();
+    uint32_t sum = (n > 2) ? _osSum32 : _osSum16;
+    sei();
+    return (long)((sum + (1UL << (n - 1))) >> n);
+}
+
+long _M328P_ADC::readOversampled()
+{
+    if (!startOversampledReading()) return -1;
+    while (!_osDone) ACP_IDLE();
+    return getOversampledReading();
+}
+
+
+
+// SCANNING: SEVERAL PINS IN THE BACKGROUND
+// ========================================
+
+// Watching levels. Each watched channel has a zone; a reading is compared
+// with the levels, moved out by the hysteresis on the side the channel is
+// already beyond, and a new zone sets the channel's event bit. Channels
+// start ACP_INSIDE, so one outside at the start signals straight away.
+
+static int              _watchLow[ACP_MAX_WATCH];
+static int              _watchHigh[ACP_MAX_WATCH];
+static uint8_t          _watchHyst[ACP_MAX_WATCH];
+static uint8_t          _watchZones[ACP_MAX_WATCH];
+static uint8_t          _watchMask;          // channels with levels set
+static volatile uint8_t _watchEventBits;
+static void (* volatile _watchFunc)(void);
+
+// Internal: from the done interrupt.
+static inline void _watchCheck(const uint8_t channel, const int reading)
+{
+    uint8_t z = _watchZones[channel];
+    int low = _watchLow[channel], high = _watchHigh[channel];
+    if (z == ACP_BELOW)      low  += _watchHyst[channel];
+    else if (z == ACP_ABOVE) high -= _watchHyst[channel];
+    uint8_t now = (reading < low) ? ACP_BELOW
+                : (reading > high) ? ACP_ABOVE : ACP_INSIDE;
+    if (now == z) return;
+    _watchZones[channel] = now;
+    _watchEventBits |= (1 << channel);
+    if (_watchFunc) (*_watchFunc)();
+}
+
+static void _watchISR(void)
+{
+    uint16_t v;
+    _acpLastReading(v);
+    if (_watchMask & 1) _watchCheck(0, (int)v);
+}
+
+void _M328P_ADC::watchLevels(const uint8_t channel, const int low,
+                             const int high, const uint8_t hysteresis)
+{
+    if (channel >= ACP_MAX_WATCH) return;
+    uint8_t bit = (1 << channel);
+    cli();
+    _watchLow[channel]   = low;
+    _watchHigh[channel]  = high;
+    _watchHyst[channel]  = hysteresis;
+    _watchZones[channel] = ACP_INSIDE;
+    _watchEventBits &= ~bit;
+    if (low <= high) _watchMask |= bit;
+    else             _watchMask &= ~bit;
+    sei();
+}
+
+void _M328P_ADC::watchPin(void (*event)(void))
+{
+    _watchFunc = event;
+    attachDoneInterruptFunction(_watchISR);
+    interruptOnDone();
+}
+
+void _M328P_ADC::stopWatching()
+{
+    noInterruptOnDone();
+    detachDoneInterruptFunction();
+    _watchFunc = 0;
+}
+
+uint8_t _M328P_ADC::watchEvents()
+{
+    cli();
+    uint8_t e = _watchEventBits;
+    _watchEventBits = 0;
+    sei();
+    return e;
+}
+
+uint8_t _M328P_ADC::watchZone(const uint8_t channel)
+    {return (channel < ACP_MAX_WATCH) ? _watchZones[channel] : ACP_INSIDE;}
+
+// Idle sleep keeps the timers, and so the triggers, running. Each reading
+// wakes the CPU for its interrupt; back to sleep unless it was an event.
+uint8_t _M328P_ADC::sleepUntilWatchEvent()
+{
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    cli();
+    while (!_watchEventBits)
+    {
+        sleep_enable();
+        sei();
+        sleep_cpu();
+        sleep_disable();
+        cli();
+    }
+    sei();
+    return watchEvents();
+}
+
+
+// Free-running conversions, the done interrupt rewrites ADMUX each time.
+// ADMUX is buffered: by the time the ISR runs, the next conversion has already
+// started on the old pin, so a new pin selection only applies to the
+// conversion after that. The ISR therefore keeps a "tag" (index into the
+// pin list) for each of the two conversions in the pipeline.
+
+#define SCAN_DISCARD 0x80    // tag bit: throw this conversion's result away.
+
+static uint8_t          _scanMux[ACP_MAX_SCAN_PINS]; // MUX values 0..7
+static uint8_t          _scanNumPins;
+static volatile int   * _scanResults;
+static uint8_t          _scanSettle;     // discarded conversions per switch
+static uint8_t          _scanAdmux;      // REFS and ADLAR bits while scanning
+static uint8_t          _scanPos;        // next pin to hand out
+static uint8_t          _scanStep;       // settle conversions done on it
+static uint8_t          _scanTagDone;    // conversion finishing at next ISR
+static uint8_t          _scanTagNext;    // conversion after that
+static volatile uint16_t _scanSweepCount;
+static uint16_t         _scanSweepsSeen;
+static void (* volatile _scanReadingFunc)(const uint8_t, const int);
+
+// Internal: tag for the next conversion to be set up.
+static uint8_t _scanAdvance(void)
+{
+    uint8_t tag = _scanPos;
+    if (_scanStep < _scanSettle) {_scanStep++; return tag | SCAN_DISCARD;}
+    _scanStep = 0;
+    if (++_scanPos >= _scanNumPins) _scanPos = 0;
+    return tag;
+}
+
+// Internal: the done interrupt function while scanning.
+static void _scanISR(void)
+{
+    uint8_t tag = _scanTagDone;
+    if (!(tag & SCAN_DISCARD))
+    {
+        int r = (_scanAdmux & (1<<ADLAR)) ? (int)ADCH : (int)ADC;
+        _scanResults[tag] = r;
+        if (tag < ACP_MAX_WATCH && (_watchMask & (1 << tag))) _watchCheck(tag, r);
+        if (_scanReadingFunc) (*_scanReadingFunc)(tag, r);
+        if (tag == _scanNumPins - 1) _scanSweepCount++;
+    }
+    _scanTagDone = _scanTagNext;
+    _scanTagNext = _scanAdvance();
+    ADMUX = _scanAdmux | _scanMux[_scanTagNext & 0x7f];  // for conversion after next
+}
+
+void _M328P_ADC::scanPins(const uint8_t * pins, const uint8_t numPins,
+                          volatile int * results)
+{
+    uint8_t n = (numPins > ACP_MAX_SCAN_PINS) ? ACP_MAX_SCAN_PINS : numPins;
+    for (uint8_t i = 0; i < n; i++)
+    {
+        uint8_t pin = pins[i];
+        if (pin > 13) pin -= 14;  // Arduino A0 = 14, etc. MUX needs 0..7.
+        _scanMux[i] = pin & 0x07;
+        disconnectPinDigitalInput(pin);
+    }
+    _scanNumPins = n;
+    _scanResults = results;
+}
+
+void _M328P_ADC::scanSettle(const uint8_t discards) {_scanSettle = discards;}
+
+void _M328P_ADC::onScanReading(void (*fn)(const uint8_t, const int))
+    {_scanReadingFunc = fn;}
+
+void _M328P_ADC::startScan()
+{
+    if (_scanNumPins == 0) return;
+    cli();
+    ADCSRA &= ~((1<<ADATE)|(1<<ADIE));     // stop retriggering, no interrupts
+    loop_until_bit_is_clear(ADCSRA, ADSC); // let a running conversion finish
+    _scanAdmux = ADMUX & 0xe0;
+    _scanPos = 0; _scanStep = 0;
+    _scanSweepCount = 0; _scanSweepsSeen = 0;
+    // The first two conversions both run on pins[0]: no ISR has run yet to
+    // change the MUX. Throw the first away (it may be the 25-clock one).
+    _scanTagDone = SCAN_DISCARD;
+    _scanTagNext = _scanAdvance();
+    ADMUX = _scanAdmux | _scanMux[0];
+    _ADCDoneFunc = _scanISR;
+    ADCSRB = 0x00;                         // trigger source 0 = free running.
+    ADCSRA |= (1<<ADIF);                   // clear pending interrupt.
+    _adcCold = false;
+    ADCSRA |= (1<<ADATE) | (1<<ADIE) | (1<<ADSC);
+    sei();
+}
+
+void _M328P_ADC::stopScan()
+{
+    cli();
+    ADCSRA &= ~((1<<ADATE)|(1<<ADIE));     // stop free running
+    _ADCDoneFunc = 0;
+    sei();
+    loop_until_bit_is_clear(ADCSRA, ADSC);
+    ADCSRA |= (1<<ADIF);                   // after the last one finished
+    ADMUX = _scanAdmux | 0x0f;             // internal ground.
+    for (uint8_t i = 0; i < _scanNumPins; i++)
+        reconnectPinDigitalInput(_scanMux[i]);
+}
+
+bool _M328P_ADC::scanReady()
+{
+    uint16_t sweeps = scanSweeps();
+    if (sweeps == _scanSweepsSeen) return false;
+    _scanSweepsSeen = sweeps;
+    return true;
+}
+
+int _M328P_ADC::scanReading(const uint8_t index)
+{
+    cli();
+    int r = _scanResults[index];  // two bytes: don't let the ISR in between.
+    sei();
+    return r;
+}
+
+uint16_t _M328P_ADC::scanSweeps()
+{
+    cli();
+    uint16_t n = _scanSweepCount;
+    sei();
+    return n;
+}
+
+
+
+// Channels: scanning with settings per channel.
+// Single conversions, each started from the done interrupt after setting up
+// the next channel, so ADMUX and the clock can change between any two. The
+// list is put in order once, in channelList(): by reference, then clock,
+// then bit depth, so that neighbours differ in as few registers as
+// possible. Cycles run forwards and backwards in turn: the first channel of
+// a cycle is the last of the one before and needs no switch at all.
+
+static uint8_t          _chAdmux[ACP_MAX_SCAN_PINS];   // in reading order
+static uint8_t          _chPrescale[ACP_MAX_SCAN_PINS];
+static uint8_t          _chDiscards[ACP_MAX_SCAN_PINS];
+static uint8_t          _chIndex[ACP_MAX_SCAN_PINS];   // results[] index
+static uint8_t          _chNum;
+static volatile int   * _chResults;
+static uint8_t          _chPos;          // order position being read
+static bool             _chForward;      // direction of this cycle
+static volatile uint8_t _chStep;         // readings still to throw away
+static bool             _chRepeat;       // startChannels(): keep going
+static volatile bool    _chRunning;
+static volatile uint16_t _chCycleCount;
+static uint16_t         _chCyclesSeen;
+
+// Internal: set up order position pos and start its first conversion.
+static void _chBegin(const uint8_t pos)
+{
+    _chPos = pos;
+    if (ADMUX != _chAdmux[pos]) _setADMUX(_chAdmux[pos]);
+    uint8_t ps = _chPrescale[pos], discards = _chDiscards[pos];
+    if (_refSettling)                       // 70 us of readings, at least
+    {
+        uint16_t conv = 13U << (ps ? ps : 1);   // CPU cycles per conversion
+        uint8_t  n    = (BANDGAP_SETTLE_CYCLES + conv - 1) / conv;
+        if (n > discards) discards = n;
+        _refSettling = false;
+    }
+    _chStep = discards;
+    ADCSRA = (ADCSRA & ~((1<<ADIF) | 0x07)) | ps | (1<<ADSC);
+}
+
+static void _channelISR(void)
+{
+    if (_chStep) {_chStep--; ADCSRA |= (1<<ADSC); return;}
+
+    uint8_t pos = _chPos;
+    _chResults[_chIndex[pos]] = (_chAdmux[pos] & (1<<ADLAR)) ? (int)ADCH : (int)ADC;
+
+    if (_chForward ? (pos == _chNum - 1) : (pos == 0))   // end of a cycle
+    {
+        _chCycleCount++;
+        _chForward = !_chForward;
+        if (!_chRepeat)
+        {
+            ADCSRA &= ~((1<<ADIE) | (1<<ADIF));
+            _ADCDoneFunc = 0;
+            _chRunning = false;
+            return;
+        }
+        _chBegin(pos);          // the same channel again: no switch
+        return;
+    }
+    _chBegin(_chForward ? pos + 1 : pos - 1);
+}
+
+static uint8_t _chRefs(const uint8_t reference)
+{
+    return reference == ACP_REF_INTERNAL ? ((1<<REFS1) | (1<<REFS0))
+         : reference == ACP_REF_EXTERNAL ? 0 : (1<<REFS0);
+}
+
+void _M328P_ADC::channelList(const ACPChannel * list, const uint8_t numChannels,
+                             volatile int * results)
+{
+    uint8_t n = (numChannels > ACP_MAX_SCAN_PINS) ? ACP_MAX_SCAN_PINS : numChannels;
+    uint8_t key[ACP_MAX_SCAN_PINS];
+    for (uint8_t i = 0; i < n; i++)
+    {
+        uint8_t pin = list[i].pin, mux;
+        if (pin & 0x80)   mux = pin & 0x0f;      // ACP_INPUT_...
+        else if (pin > 13) mux = (pin - 14) & 0x07;
+        else               mux = pin & 0x07;
+        unsigned long clock = list[i].clock ? list[i].clock : 1;
+        uint8_t ps = _acpPrescaleBits(F_CPU / clock);
+        if (ps == 0) ps = 0x07;
+        uint8_t refs = _chRefs(list[i].reference);
+        uint8_t adlar = (list[i].bits == 8) ? (1<<ADLAR) : 0;
+
+        // Insert in order of reference, then prescaler, then ADLAR.
+        uint8_t order = refs | (ps << 1) | (adlar ? 1 : 0);
+        uint8_t j = i;
+        while (j > 0 && key[j - 1] > order) j--;
+        for (uint8_t k = i; k > j; k--)
+        {
+            key[k] = key[k - 1];
+            _chAdmux[k] = _chAdmux[k - 1]; _chPrescale[k] = _chPrescale[k - 1];
+            _chDiscards[k] = _chDiscards[k - 1]; _chIndex[k] = _chIndex[k - 1];
+        }
+        key[j]         = order;
+        _chAdmux[j]    = refs | adlar | mux;
+        _chPrescale[j] = ps;
+        _chDiscards[j] = list[i].discards;
+        _chIndex[j]    = i;
+    }
+    _chNum = n;
+    _chResults = results;
+}
+
+// Internal: stop other use of the ADC and start a cycle, going whichever
+// way starts on the reference already selected.
+static void _chStart(const bool repeat)
+{
+    cli();
+    ADCSRA &= ~((1<<ADATE)|(1<<ADIE));     // stop retriggering, no interrupts
+    loop_until_bit_is_clear(ADCSRA, ADSC);
+    for (uint8_t i = 0; i < _chNum; i++)
+        if (!(_chAdmux[i] & 0x08)) DIDR0 |= (1 << (_chAdmux[i] & 0x07)) & 0x3f;
+    uint8_t refs = ADMUX & 0xc0;
+    if ((_chAdmux[0] & 0xc0) == refs)                _chForward = true;
+    else if ((_chAdmux[_chNum - 1] & 0xc0) == refs)  _chForward = false;
+    _chRepeat = repeat;
+    _chRunning = true;
+    _chCycleCount = 0; _chCyclesSeen = 0;
+    _ADCDoneFunc = _channelISR;
+    ADCSRA |= (1<<ADIF);                   // clear pending interrupt.
+    ADCSRA |= (1<<ADIE);
+    _adcCold = false;
+    _chBegin(_chForward ? 0 : _chNum - 1);
+    sei();
+}
+
+void _M328P_ADC::startChannels() {if (_chNum) _chStart(true);}
+
+// Puts back the input, reference, ADC clock and digital inputs it found.
+void _M328P_ADC::readChannels()
+{
+    if (_chNum == 0) return;
+    uint8_t oldADMUX = ADMUX, oldPrescale = ADCSRA & 0x07, oldDIDR0 = DIDR0;
+    _chStart(false);
+    while (_chRunning) ACP_IDLE();
+    ADCSRA = (ADCSRA & ~0x07) | oldPrescale;
+    DIDR0  = oldDIDR0;
+    _setADMUX(oldADMUX);
+    _settleReference();
+}
+
+void _M328P_ADC::stopChannels()
+{
+    cli();
+    _chRepeat = false;
+    ADCSRA &= ~(1<<ADIE);
+    _ADCDoneFunc = 0;
+    _chRunning = false;
+    sei();
+    loop_until_bit_is_clear(ADCSRA, ADSC);
+    ADCSRA |= (1<<ADIF);                   // after the last one finished
+    ADMUX |= 0x0f;                         // internal ground.
+    for (uint8_t i = 0; i < _chNum; i++)
+        if (!(_chAdmux[i] & 0x08)) reconnectPinDigitalInput(_chAdmux[i] & 0x07);
+}
+
+bool _M328P_ADC::channelsReady()
+{
+    cli();
+    uint16_t cycles = _chCycleCount;
+    sei();
+    if (cycles == _chCyclesSeen) return false;
+    _chCyclesSeen = cycles;
+    return true;
+}
+
+int _M328P_ADC::channelReading(const uint8_t index)
+{
+    cli();
+    int r = _chResults[index];
+    sei();
+    return r;
+}
+
+
 // SPECIALS: Read Internal Sensors - no pin selected.
 
 // Raw ADC reading 0..1023 from internal ground connection.
@@ -526,46 +1789,301 @@ int _M328P_ADC::readInternalReference()
 {
     uint8_t oldADCSRA = ADCSRA, oldADMUX = ADMUX;
     ADCSRA &= 0x97;        // turn off ADATE and ADIE, leave prescale bits
-    ADMUX  &= 0xf0;        // reset source bits. leave reference bits.
-    ADMUX  |= 0xce;        // turn off ADLAR, source 14 = internal ref.
-    _delay_us(70);         // wait for bandgap reference to stabilise
+    // Leave reference bits, turn off ADLAR, source 14 = internal ref.
+    _setADMUX((ADMUX & 0xc0) | 0x0e);
+    _settleReference();    // wait for bandgap reference to stabilise
+    _adcCold = false;
     ADCSRA |= (1<<ADSC);   // start conversion
     loop_until_bit_is_clear(ADCSRA, ADSC);
     int reading = (int)ADC;
-    ADMUX = oldADMUX; ADCSRA = oldADCSRA;
+    _restoreADMUX(oldADMUX); ADCSRA = oldADCSRA;
     return reading;
 }
 
-// Raw ADC reading from internal temperature sensor. (around 220?)
+// Raw ADC reading from internal temperature sensor, typically about 290 at
+// 25 C (314 mV against the 1.1 V reference).
 
 int _M328P_ADC::readTempSensor()
 {
     uint8_t oldADCSRA = ADCSRA, oldADMUX = ADMUX;
     ADCSRA &= 0x97;     // turn off ADATE and ADIE, leave prescale bits
-    ADMUX = 0xc8;       // bits 7,6 = internal ref., source 8 = Temp sensor.
-    _delay_us(70);      // wait for internal reference to stabilise
+    _setADMUX(0xc8);    // bits 7,6 = internal ref., source 8 = Temp sensor.
+    _settleReference(); // wait for internal reference to stabilise
+    _adcCold = false;
     ADCSRA |= (1<<ADSC);   // start conversion
     loop_until_bit_is_clear(ADCSRA, ADSC);
     int reading = (int)ADC;
-    ADMUX = oldADMUX; ADCSRA = oldADCSRA; // reset reference and selected pin.
+    _restoreADMUX(oldADMUX); ADCSRA = oldADCSRA; // reset reference and selected pin.
     return reading;
 }
 
+// Supply voltage from the bandgap: reading = Vbg * 1024 / Vcc, so
+// Vcc = Vbg * 1024 * n / (sum of n readings). One 32-bit integer division.
+
+#define SUPPLY_READINGS 8      // 8 x 1023 fits in 16 bits.
+
+// Sum of SUPPLY_READINGS readings of the bandgap against AVCC, after one
+// discarded reading.
+static uint16_t _bandgapSum(void)
+{
+    // Not ADSC: putting it back would start a stray reading on the old ADMUX.
+    uint8_t oldADCSRA = ADCSRA & ~((1<<ADSC)|(1<<ADIF)), oldADMUX = ADMUX;
+    ADCSRA &= 0x97;        // turn off ADATE and ADIE, leave prescale bits
+    loop_until_bit_is_clear(ADCSRA, ADSC);   // one already under way
+    _setADMUX(0x4e);       // AVCC reference, source 14 = internal ref.
+    _settleReference();    // wait for bandgap reference to stabilise
+    uint16_t sum = 0;
+    _adcCold = false;
+    for (int8_t i = -1; i < SUPPLY_READINGS; i++)
+    {
+        ADCSRA |= (1<<ADSC);
+        loop_until_bit_is_clear(ADCSRA, ADSC);
+        if (i >= 0) sum += ADC;
+    }
+    _restoreADMUX(oldADMUX); ADCSRA = oldADCSRA;
+    return sum;
+}
+
+uint16_t _M328P_ADC::_supplyFromSum(const uint16_t sum)
+{
+    if (sum == 0) return 0;
+    uint32_t scaled = (uint32_t)_bandgapmV * 1024 * SUPPLY_READINGS;
+    return (uint16_t)((scaled + sum / 2) / sum);
+}
+
+uint16_t _M328P_ADC::getSupplyMillivolts() {return _supplyFromSum(_bandgapSum());}
+
 // Get voltage at AVCC (ATmega's battery voltage) as a floating point number.
 // Unit is volts.
 
-float _M328P_ADC::getSupplyVoltage()
+float _M328P_ADC::getSupplyVoltage() {return getSupplyMillivolts() / 1000.0;}
+
+
+// Calibration block in EEPROM at ACP_EEPROM_ADDRESS:
+//  +0  internal reference, millivolts
+//  +2  the same, bits inverted: a check that the value was written by us.
+//  +4  temperature offset, centi-C
+//  +6  temperature slope, 4096 = 1.0
+//  +8  last temperature calibration point: the curve's temperature
+//  +10   and the true one, centi-C
+//  +12 the four before XORed together, bits inverted: check.
+
+#define EE_BANDGAP       ((uint16_t *)(ACP_EEPROM_ADDRESS))
+#define EE_BANDGAP_CHECK ((uint16_t *)(ACP_EEPROM_ADDRESS + 2))
+#define EE_TEMP_OFFSET   ((uint16_t *)(ACP_EEPROM_ADDRESS + 4))
+#define EE_TEMP_GAIN     ((uint16_t *)(ACP_EEPROM_ADDRESS + 6))
+#define EE_TEMP_TYPICAL  ((uint16_t *)(ACP_EEPROM_ADDRESS + 8))
+#define EE_TEMP_TRUE     ((uint16_t *)(ACP_EEPROM_ADDRESS + 10))
+#define EE_TEMP_CHECK    ((uint16_t *)(ACP_EEPROM_ADDRESS + 12))
+
+// Data sheet: the bandgap is 1.0 to 1.2 V. Anything else is not ours.
+#define BANDGAP_MIN_MV 1000
+#define BANDGAP_MAX_MV 1200
+
+uint16_t _M328P_ADC::calibrateBandgap(const uint16_t supplyMillivolts)
 {
-    uint8_t oldADCSRA = ADCSRA, oldADMUX = ADMUX;
-    referenceDefault();
-    singleReadingMode();
-    int rdg = 0;
-    for (short i = 0; i < 4; i++) {rdg = readInternalReference();}
-    rdg = (rdg + 2 / 4);   // rounded average of four readings.
+    uint16_t sum = _bandgapSum();
+    uint32_t scaled = (uint32_t)supplyMillivolts * sum;
+    uint32_t mV = (scaled + 1024UL * SUPPLY_READINGS / 2) / (1024UL * SUPPLY_READINGS);
+    if (mV < BANDGAP_MIN_MV || mV > BANDGAP_MAX_MV) return 0;   // not a bandgap
+    _bandgapmV = (uint16_t)mV;
+    eeprom_update_word(EE_BANDGAP, _bandgapmV);
+    eeprom_update_word(EE_BANDGAP_CHECK, (uint16_t)~_bandgapmV);
+    return _bandgapmV;
+}
 
-    ADMUX = oldADMUX; ADCSRA = oldADCSRA;
-    if (rdg == 0) return 0;
-    return (bandgapV * 1023.0 / (float)rdg);
+// Bandgaps outside BANDGAP_MIN_MV .. MAX_MV are not ours; temperature
+// slopes outside 0.5 .. 2.0 aren't either.
+void _M328P_ADC::_loadCalibration()
+{
+    uint16_t mV = eeprom_read_word(EE_BANDGAP);
+    if (eeprom_read_word(EE_BANDGAP_CHECK) == (uint16_t)~mV
+        && mV >= BANDGAP_MIN_MV && mV <= BANDGAP_MAX_MV)
+        _bandgapmV = mV;
+
+    uint16_t offset  = eeprom_read_word(EE_TEMP_OFFSET);
+    uint16_t gain    = eeprom_read_word(EE_TEMP_GAIN);
+    uint16_t typical = eeprom_read_word(EE_TEMP_TYPICAL);
+    uint16_t actual  = eeprom_read_word(EE_TEMP_TRUE);
+    if (eeprom_read_word(EE_TEMP_CHECK) == (uint16_t)~(offset ^ gain ^ typical ^ actual)
+        && gain >= 2048 && gain <= 8192)
+    {
+        _tempOffset = (int16_t)offset; _tempGain = gain;
+        _tempPointTypical = (int16_t)typical; _tempPointC = (int16_t)actual;
+        _tempPointSet = true;
+    }
+}
+
+
+// Temperature in centi-C.
+// The datasheet's typical sensor voltages (table "Temperature vs. Sensor
+// Output Voltage"), as straight lines between its points. The reading
+// gives sensor millivolts from the internal reference voltage, the curve
+// a typical temperature, and the calibration, if any, corrects that:
+//   T = offset + typical * gain / 4096
+// No division: the slopes are in the table, the reading-to-millivolts
+// scale is a multiply and a shift.
+
+typedef struct {
+    uint16_t mV;        // sensor voltage at the start of the segment
+    int16_t  centiC;    // temperature there
+    uint16_t slope;     // centi-C per mV, x 256, up to the next entry
+} _ACPTempPoint;
+
+static const _ACPTempPoint _tempCurve[] PROGMEM = {
+    {242, -4500, 24889},    // -45 C .. 25 C: 70 degrees over 72 mV
+    {314,  2500, 23273}     //  25 C .. 85 C: 60 degrees over 66 mV, and beyond
+};
+#define TEMP_SEGMENTS (uint8_t)(sizeof(_tempCurve) / sizeof(_tempCurve[0]))
+
+// Typical temperature for a reading in 16ths. Below -45 and above 85 C the
+// end segments carry on.
+static int16_t _typicalCentiC(const uint16_t r16, const uint16_t bandgapmV)
+{
+    int32_t mV16 = ((uint32_t)r16 * bandgapmV + 512) >> 10;   // 16ths of a mV
+    uint8_t i = 0;
+    while (i + 1 < TEMP_SEGMENTS
+           && mV16 >= (int32_t)pgm_read_word(&_tempCurve[i + 1].mV) * 16) i++;
+    int32_t d = mV16 - (int32_t)pgm_read_word(&_tempCurve[i].mV) * 16;
+    return (int16_t)pgm_read_word(&_tempCurve[i].centiC)
+         + (int16_t)((d * (int32_t)pgm_read_word(&_tempCurve[i].slope) + 2048) >> 12);
+}
+
+// Mean of 4^bits temperature sensor readings (bits 0..4), in 16ths, after
+// one discarded reading.
+static uint16_t _tempSensor16(const uint8_t bits)
+{
+    uint16_t n = 1 << (2 * bits);
+    uint8_t oldADCSRA = ADCSRA & ~((1<<ADSC)|(1<<ADIF)), oldADMUX = ADMUX;
+    ADCSRA &= 0x97;        // turn off ADATE and ADIE, leave prescale bits
+    loop_until_bit_is_clear(ADCSRA, ADSC);   // as _bandgapSum()
+    _setADMUX(0xc8);       // internal reference, source 8 = temperature.
+    _settleReference();
+    uint32_t sum = 0;
+    _adcCold = false;
+    for (int16_t i = -1; i < (int16_t)n; i++)
+    {
+        ADCSRA |= (1<<ADSC);
+        loop_until_bit_is_clear(ADCSRA, ADSC);
+        if (i >= 0) sum += ADC;
+    }
+    _restoreADMUX(oldADMUX); ADCSRA = oldADCSRA;
+    if (bits <= 2) return (uint16_t)(sum << (4 - 2 * bits));
+    return (uint16_t)((sum + (1UL << (2 * bits - 5))) >> (2 * bits - 4));
+}
+
+int16_t _M328P_ADC::getTemperatureCentiC(const uint8_t oversampleBits)
+{
+    int16_t typical = _typicalCentiC(
+        _tempSensor16(oversampleBits > 4 ? 4 : oversampleBits), _bandgapmV);
+    return _tempOffset + (int16_t)(((int32_t)typical * _tempGain + 2048) >> 12);
+}
+
+uint8_t _M328P_ADC::calibrateTemperature(const int16_t centiC)
+{
+    int16_t typical = _typicalCentiC(_tempSensor16(4), _bandgapmV);
+    uint8_t points = 1;
+    int16_t span = typical - _tempPointTypical;
+    if (_tempPointSet && (span >= 500 || span <= -500))
+    {
+        int32_t gain = ((int32_t)centiC - _tempPointC) * 4096 / span;
+        if (gain >= 2048 && gain <= 8192) {_tempGain = (uint16_t)gain; points = 2;}
+    }
+    _tempOffset = centiC - (int16_t)(((int32_t)typical * _tempGain + 2048) >> 12);
+    _tempPointTypical = typical; _tempPointC = centiC; _tempPointSet = true;
+
+    eeprom_update_word(EE_TEMP_OFFSET,  (uint16_t)_tempOffset);
+    eeprom_update_word(EE_TEMP_GAIN,    _tempGain);
+    eeprom_update_word(EE_TEMP_TYPICAL, (uint16_t)typical);
+    eeprom_update_word(EE_TEMP_TRUE,    (uint16_t)centiC);
+    eeprom_update_word(EE_TEMP_CHECK,
+        (uint16_t)~((uint16_t)_tempOffset ^ _tempGain ^ (uint16_t)typical ^ (uint16_t)centiC));
+    return points;
+}
+
+
+// Background internal-sensor readings.
+// The done interrupt throws away readings until the reference has had time
+// to settle, plus one, then adds up the readings wanted. The ADC's own
+// conversions time the settling, so no timer is needed.
+
+#define SENSOR_TEMPERATURE    0
+#define SENSOR_SUPPLY         1
+
+static volatile uint8_t  _sensorDiscards;   // readings still to throw away
+static volatile uint8_t  _sensorCount;      // readings still to add up
+static volatile uint16_t _sensorSum;
+static volatile bool     _sensorDone;
+static uint8_t           _sensorKind;
+static uint8_t           _sensorOldADMUX, _sensorOldADCSRA;
+static voidfnptr         _sensorSavedFunc;  // user's done function, if any
+static voidfnptr         _sensorCallback;
+
+static void _sensorISR(void)
+{
+    if (_sensorDiscards) _sensorDiscards--;
+    else
+    {
+        _sensorSum += ADC;
+        if (--_sensorCount == 0)
+        {
+            _restoreADMUX(_sensorOldADMUX);
+            ADCSRA = _sensorOldADCSRA;
+            _ADCDoneFunc = _sensorSavedFunc;
+            _sensorDone = true;
+            if (_sensorCallback) (*_sensorCallback)();
+            return;
+        }
+    }
+    ADCSRA |= (1<<ADSC);                    // next reading
+}
+
+static void _sensorStart(const uint8_t kind, const uint8_t admux,
+                         const uint8_t readings, voidfnptr done)
+{
+    cli();
+    _sensorOldADMUX  = ADMUX;
+    _sensorOldADCSRA = ADCSRA & ~((1<<ADSC)|(1<<ADIF));
+    ADCSRA &= ~((1<<ADATE)|(1<<ADIE));
+    loop_until_bit_is_clear(ADCSRA, ADSC);
+
+    _setADMUX(admux);
+    _sensorDiscards = 1;
+    if (_refSettling)                       // 70 us of readings, plus one
+    {
+        uint8_t  ps   = ADCSRA & 0x07;
+        uint16_t conv = 13U << (ps ? ps : 1);   // CPU cycles per conversion
+        _sensorDiscards += (BANDGAP_SETTLE_CYCLES + conv - 1) / conv;
+        _refSettling = false;
+    }
+    _sensorCount    = readings;
+    _sensorSum      = 0;
+    _sensorDone     = false;
+    _sensorKind     = kind;
+    _sensorCallback = done;
+    _sensorSavedFunc = _ADCDoneFunc;
+    _ADCDoneFunc    = _sensorISR;
+
+    ADCSRA |= (1<<ADIF);
+    _adcCold = false;
+    ADCSRA |= (1<<ADIE) | (1<<ADSC);
+    sei();
+}
+
+// Internal reference, source 8 = temperature sensor. One reading.
+void _M328P_ADC::beginTempSensorRead(void (*done)(void))
+    {_sensorStart(SENSOR_TEMPERATURE, 0xc8, 1, done);}
+
+// AVCC reference, source 14 = internal reference.
+void _M328P_ADC::beginSupplyVoltageRead(void (*done)(void))
+    {_sensorStart(SENSOR_SUPPLY, 0x4e, SUPPLY_READINGS, done);}
+
+bool _M328P_ADC::sensorReadingReady() {return _sensorDone;}
+
+uint16_t _M328P_ADC::getSensorReading()
+{
+    if (_sensorKind == SENSOR_SUPPLY) return _supplyFromSum(_sensorSum);
+    return _sensorSum;
 }
 
 struct _M328P_ADC InternalADC;
\ No newline at end of file
@@ -5,16 +5,56 @@
 // https://github.com/gvp-257/analogcontrolpanel
 
 // Values for the "reference" function. (Like Arduino's analogReadReference().)
+// The same values as Arduino.h's: the library's .cpp doesn't include it, and
+// a sketch's reference(INTERNAL) must mean the same there.
 #ifndef DEFAULT
-#define DEFAULT 0
+#define DEFAULT 1
 #endif
 #ifndef INTERNAL
-#define INTERNAL 1
+#define INTERNAL 3
 #endif
 #ifndef EXTERNAL
-#define EXTERNAL 2
+#define EXTERNAL 0
 #endif
 
+// References for channel lists and ACPConfigChange: the REFS1:REFS0 bits of
+// ADMUX. Equal to Arduino's DEFAULT, INTERNAL and EXTERNAL on the ATmega328P.
+#define ACP_REF_EXTERNAL 0
+#define ACP_REF_AVCC     1
+#define ACP_REF_INTERNAL 3
+
+// Maximum number of pins in a scan list: scanPins().
+#ifndef ACP_MAX_SCAN_PINS
+#define ACP_MAX_SCAN_PINS 8
+#endif
+
+// Channels for watchLevels(): one bit each in watchEvents().
+#define ACP_MAX_WATCH 8
+
+// Zones for watchZone().
+#define ACP_BELOW  0
+#define ACP_INSIDE 1
+#define ACP_ABOVE  2
+
+// Acquisition counters, InternalADC.counters(): define ACP_INSTRUMENT here,
+// or as a build flag, to have them. Without it they cost nothing. A
+// #define in the sketch doesn't reach the library's .cpp, and does nothing.
+// #define ACP_INSTRUMENT
+
+// EEPROM address of the library's calibration block (16 bytes, at the end of
+// the EEPROM by default): calibrateBandgap().
+#ifndef ACP_EEPROM_ADDRESS
+#define ACP_EEPROM_ADDRESS (E2END - 15)
+#endif
+
+#include "ACP_RingBuffer.h"
+#include "ACP_PackedBuffer.h"
+#include "ACP_PingPongBuffer.h"
+#include "ACP_Filters.h"
+#include "ACP_Keypad.h"
+#include "ACP_Timestamps.h"
+#include "ACP_Stats.h"
+
 #ifndef cli
 #define cli() __asm__ __volatile__ ("cli" ::: "memory")
 #endif
@@ -22,6 +62,20 @@
 #define sei()  __asm__ __volatile__ ("sei" ::: "memory")
 #endif
 
+// Body of loops that wait for an interrupt to set a flag. Nothing on the AVR;
+// the host model (extras/host) lets simulated time pass.
+#ifndef ACP_IDLE
+#define ACP_IDLE()
+#endif
+
+// Counts for counters(), since clearCounters().
+typedef struct {
+    uint32_t conversions;    // readings that came in
+    uint16_t overwritten;    // readings replaced by the next before use
+    uint16_t triggersLost;   // triggers while a reading was running
+    uint16_t longestDone;    // longest done interrupt, CPU cycles
+} ACPCounters;
+
 /*
  * Settings object type for saveSettings() and restoreSettings(settings)
 */
@@ -32,6 +86,17 @@ typedef struct {
 }
 InternalADCSettings;
 
+#include "ACP_Config.h"  // ACPConfig<>: compile-time settings.
+
+// One entry in a channel list for channelList(): what to read and how.
+typedef struct {
+    uint8_t       pin;        // A0..A7, or ACP_INPUT_TEMPERATURE etc.
+    uint8_t       reference;  // ACP_REF_AVCC, ACP_REF_INTERNAL or ACP_REF_EXTERNAL
+    uint8_t       bits;       // 8 or 10
+    unsigned long clock;      // ADC clock, Hz. F_CPU / clock = 2 .. 128
+    uint8_t       discards;   // readings thrown away before the one kept
+} ACPChannel;
+
 /* Sections correspond to the "seven 'S'es" of using an ADC:
  *
  * STATE: on/off
@@ -58,6 +123,21 @@ public:
     InternalADCSettings saveSettings(void);
     void restoreSettings(InternalADCSettings);
 
+    // Power sessions: the ADC stays on from holdPower() to the matching
+    // releasePower() (they nest), or while an ACPPowerSession exists. If it
+    // was off, it goes off again at the last release, keeping its settings;
+    // or powerOffWhenIdle(ms) later, seen by idlePowerCheck() in loop()
+    // (uses Arduino's millis()). analogRead() uses a session.
+    void holdPower(void);
+    void releasePower(void);
+    void powerOffWhenIdle(const uint16_t ms);    // 0 (default): at once
+    bool idlePowerCheck(void);                   // true if still on
+
+    // The first conversion after power-up takes 25 ADC clocks, not 13.
+    // True until the library starts one. warmUp() does it now, discarded.
+    bool firstConversionPending(void);
+    void warmUp(void);
+
 
     // SCALE: ADC VOLTAGE REFERENCE
 
@@ -69,8 +149,17 @@ public:
     void referenceDefault(void);
 
     // Internal bandgap reference, nominal 1.1V.
+    // Waits for it to settle (70 us) only if it has just been selected.
     void referenceInternal(void);
+    // Around a group of internal reads: keep the bandgap running (uses the
+    // analog comparator's ACBG bit) and the reads' reference selected, so
+    // they don't wait to settle each time. releaseBandgap() puts the
+    // reference back.
+    void keepBandgapWarm(void);
+    void releaseBandgap(void);
     void setInternalReferenceVoltage(const float);
+    void setInternalReferenceMillivolts(const uint16_t);
+    uint16_t internalReferenceMillivolts(void);
 
     // External voltage reference IC on AREF pin, e.g. a TL431 or LM4040.
     void referenceExternal(void);
@@ -82,9 +171,27 @@ public:
     // SENSITIVITY/RESOLUTION/PRECISION: BIT DEPTH SETTING
     void bitDepth8(void);
     void bitDepth10(void);
-    void readResolution(const uint8_t);  // 8 or 10 - Arduino contravening own guidelines
+    void readResolution(const uint8_t);  // 8 .. 16 - Arduino contravening own guidelines
     void readResolution();               // default 10.
 
+    // 11 to 16 bits by oversampling and decimation. The done interrupt adds up
+    // 4, 16, .. 4096 readings (4 to the power of bits over 10) in the
+    // background, at the fastest clock that still gives full 10-bit accuracy.
+    // The input needs a little noise ("dither") for this to work: ditherOn().
+    // read() and friends stay 10-bit: use the oversampled readings below.
+    void bitDepth11(void);
+    void bitDepth12(void);
+    void bitDepth13(void);
+    void bitDepth14(void);
+    void bitDepth15(void);
+    void bitDepth16(void);
+
+    // Square wave on pin 3 (Timer2, OC2B), a whole number of cycles per
+    // oversampled reading. Feed it to the input through an R-C integrator
+    // (see the bitDepth12 example). Stops tone() and analogWrite() on 3 and 11.
+    void ditherOn(void);
+    void ditherOff(void);
+
 
     // SOURCE: INPUT SELECTION
 
@@ -120,6 +227,17 @@ public:
     void clock125k(void);
     void clock62k5(void);
 
+    // Auto-tuning: with a steady voltage on pin, try speed1x/2x/4x, default
+    // and internal reference, read() and free running, n readings each, and
+    // return the fastest settings whose readings scatter (standard
+    // deviation, 10-bit steps) no more than maxScatter, for
+    // restoreSettings(). None good enough: the least scattered. Leaves the
+    // ADC as it was. tunedScatter(): the scatter of the settings returned;
+    // negative if none could be measured (input at 0 or full scale).
+    InternalADCSettings autoTune(const uint8_t pin, const float maxScatter,
+                                 const uint16_t n = 100);
+    float tunedScatter(void);
+
 
     // STARTING / TRIGGERING config: When to START to take a reading
 
@@ -146,6 +264,27 @@ public:
     void triggerOnTimer1CompareB(void);
     void triggerOnTimer1Overflow(void);
 
+    // Take readings at an exact rate, paced by Timer1 (CTC mode, compare
+    // match B triggers the ADC). 1 Hz up to the ADC's limit for the current
+    // speed. Returns the rate achieved in Hz (rounded), or 0 if the rate is
+    // too fast for the ADC clock, or if another library (Servo, TimerOne,
+    // ...) defines TIMER1_COMPB_vect: nothing is changed then.
+    // Timer1 is taken over: no analogWrite() on pins 9 and 10, no Servo.
+    // Done interrupt settings are left as they are (streamInto() etc.).
+    unsigned long sampleAt(const unsigned long hz);
+    unsigned long sampleInterval(void);  // exact interval in CPU clock cycles
+    void stopSampling(void);             // stop Timer1, singleReadingMode().
+
+    // Timestamps: Timer1 counts freely from 0 at F_CPU / prescale (1, 8,
+    // 64, 256 or 1024), and the library's Timer1 overflow interrupt extends
+    // it to 32 bits. For ACPStampedBuffer (ACP_Timestamps.h). Returns Timer1
+    // ticks per second, or 0 for a prescale Timer1 doesn't have, or if
+    // another library defines TIMER1_OVF_vect. Timer1 is taken over, as with
+    // sampleAt(): not both at once.
+    unsigned long startTimestamps(const uint16_t prescale = 8);
+    unsigned long timestampNow(void);    // Timer1 ticks, 32 bits
+    void stopTimestamps(void);
+
 
     // SIGNALING: NOTIFICATION OF COMPLETION
 
@@ -172,6 +311,51 @@ public:
     // 2. See if the ADC has finished processing a reading.
     bool readingReady(void);
 
+    // 3. Queue every reading for loop() in a ring buffer, so none are lost
+    // when loop() is slower than the ADC. Uses the done interrupt.
+    // Set the trigger mode first (the trigger functions turn it off).
+    //   ACPRingBuffer16<64> readings;
+    //   InternalADC.freeRunningMode(); InternalADC.streamInto(readings);
+    //   InternalADC.startReading();
+    //   loop: while (readings.available()) {int r = readings.pop(); ...}
+    // Or into a packed buffer (ACP_PackedBuffer.h), to keep more readings,
+    // or a ping-pong buffer (ACP_PingPongBuffer.h), for writing out blocks.
+    template <typename BUFFER>
+    void streamInto(BUFFER & buffer)
+        {attachDoneInterruptFunction(buffer.adcFiller()); interruptOnDone();}
+
+    // The same, but each reading goes through a filter (ACP_Filters.h) in
+    // the interrupt first: ACPMedianFilter<5> despike;
+    //   InternalADC.streamInto(readings, despike);
+    template <typename BUFFER, typename FILTER>
+    void streamInto(BUFFER & buffer, FILTER & filter)
+    {
+        typedef _ACPFilteredFill<FILTER, BUFFER> fill;
+        cli();
+        fill::filter = &filter;
+        fill::buffer = &buffer;
+        sei();
+        attachDoneInterruptFunction(fill::isr);
+        interruptOnDone();
+    }
+    void stopStreaming(void);
+
+    // Keeping up? With ACP_INSTRUMENT defined (see the top of this file),
+    // counters of readings that came in, readings overwritten before they
+    // were used, triggers that came while the ADC was busy, and the longest
+    // done interrupt. Without it, zeros. Readings are counted by the done
+    // interrupt, or by readingReady() when polling. Overwritten readings
+    // are seen when getLastReading() is late, and, free running, from the
+    // time between readings (Timer0). Triggers are counted for sampleAt()
+    // and triggerOnTimer1Overflow(); call countTrigger() first thing in your
+    // own INT0, Timer0 or input capture interrupt function for the others.
+    // Interrupt times need Timer1 counting up: sampleAt(), startTimestamps().
+    // ACP_INSTRUMENT only matters to the library's .cpp: these are the same
+    // functions either way.
+    ACPCounters counters(void);
+    void        clearCounters(void);
+    void        countTrigger(void);
+
 
 
     // TAKING READINGS == SAMPLES WITH THE ADC
@@ -196,6 +380,25 @@ public:
 
     // With sleepRead(), the CPU is stopped. Lower noise.
     int     sleepRead(void);
+    // n sleepRead()s in one go, 10-bit, set up once: the CPU sleeps through
+    // each conversion and the done interrupt adds it up. Sum, or rounded
+    // average; then the lowest and highest of the n readings.
+    unsigned long sleepReadSum(const uint16_t n);
+    int     sleepReadAverage(const uint16_t n);
+    int     sleepReadMin(void);
+    int     sleepReadMax(void);
+
+    // Bursts: n readings from the usePin() pin, back to back as fast as the
+    // ADC goes (13 ADC clocks apart, free running), into your array:
+    // 0..255 into bytes, 0..1023 into ints. Returns the sample period
+    // achieved in CPU clock cycles, longer than 13 ADC clocks if interrupts
+    // made the loop miss readings. interruptsOff = true: none are missed,
+    // but millis() loses time on bursts longer than 1 ms.
+    unsigned long readBurst(uint8_t * buffer, const uint16_t n,
+                            const bool interruptsOff = false);
+    unsigned long readBurst(int * buffer, const uint16_t n,
+                            const bool interruptsOff = false);
+    unsigned long burstPeriod(void);     // the last burst's, CPU clock cycles
 
 
     // 2. NON-BLOCKING READS.
@@ -210,8 +413,79 @@ public:
 
     void startReading(void);
 
-
-    // 3. SPECIALS: Read Internal Sensors - no pin selected.
+    // Oversampled readings, after bitDepth11() .. bitDepth16().
+    // 0..2046 for 11 bits .. 0..65472 for 16 bits. Leaves singleReadingMode.
+    // Without one of those first (or after bitDepth8() or bitDepth10()),
+    // nothing starts: readOversampled() gives -1, startOversampledReading()
+    // false.
+    long readOversampled(void);           // blocking
+    bool startOversampledReading(void);   // non-blocking
+    bool oversampledReady(void);
+    long getOversampledReading(void);
+
+
+    // 3. SCANNING: SEVERAL PINS IN THE BACKGROUND.
+    // The ADC runs free, the "conversion complete" interrupt switches it to
+    // the next pin in the list and puts each reading in results[i] for
+    // pins[i]. Round and round until stopScan(). Uses the done interrupt, so
+    // any attached done-interrupt function is replaced while scanning.
+    // Set reference, bit depth and speed first.
+
+    void scanPins(const uint8_t * pins, const uint8_t numPins,
+                  volatile int * results);   // up to ACP_MAX_SCAN_PINS pins.
+    // Extra conversions thrown away after each pin switch, for sensors with
+    // a high output impedance (over 10K). Default 0.
+    void scanSettle(const uint8_t discards);
+    void startScan(void);
+    void stopScan(void);
+
+    bool     scanReady(void);                  // true once per complete sweep.
+    int      scanReading(const uint8_t index); // results[index], safely.
+    uint16_t scanSweeps(void);                 // sweeps since startScan().
+    // Function called from the interrupt with each reading as it comes in:
+    // fn(index, reading). A keypad's scanFiller(), say. 0 for none.
+    void     onScanReading(void (*fn)(const uint8_t index, const int reading));
+
+
+    // CHANNELS: SCANNING WITH SETTINGS PER CHANNEL.
+    // Like scanning, but each channel has its own reference, bit depth and
+    // clock (ACPChannel). Readings are taken one at a time from the done
+    // interrupt, in an order that keeps channels with the same reference
+    // together: a cycle runs through the groups and the next one back again,
+    // so k references cost k - 1 switches a cycle, not one per channel.
+    // After a switch, readings are thrown away until the reference settles.
+    // results[i] is for list[i], in the channel's bit depth.
+    void channelList(const ACPChannel * list, const uint8_t numChannels,
+                     volatile int * results);   // up to ACP_MAX_SCAN_PINS
+    void startChannels(void);      // cycle after cycle, until stopChannels()
+    void stopChannels(void);
+    void readChannels(void);       // one cycle, blocking
+    bool channelsReady(void);      // true once per complete cycle
+    int  channelReading(const uint8_t index);  // results[index], safely
+
+
+    // WATCHING LEVELS: the done interrupt compares each reading with a low
+    // and a high level, and signals loop() only when it moves to another
+    // zone: ACP_BELOW, ACP_INSIDE, or ACP_ABOVE. Hysteresis: back inside
+    // only once the reading is that much past the level, so a noisy reading
+    // sitting on a level doesn't signal over and over.
+    // Channel: index in the scan list while scanning; 0 for the usePin()
+    // pin with watchPin(). Up to ACP_MAX_WATCH channels. Levels in reading
+    // units (0..255 after bitDepth8()). Set low > high to stop watching one.
+    void    watchLevels(const uint8_t channel, const int low, const int high,
+                        const uint8_t hysteresis = 0);
+    // Watch the usePin() pin: freeRunningMode() or a trigger, then
+    // watchPin(), then startReading() if free running. Not while scanning:
+    // scans check their channels' levels themselves.
+    void    watchPin(void (*event)(void) = 0);  // function called on a change
+    void    stopWatching(void);
+    uint8_t watchEvents(void);     // bit n: channel n changed zone; clears
+    uint8_t watchZone(const uint8_t channel);
+    // Sleep (idle) until a channel changes zone. Returns watchEvents().
+    uint8_t sleepUntilWatchEvent(void);
+
+
+    // 4. SPECIALS: Read Internal Sensors - no pin selected.
 
     // Raw ADC reading 0..1023 from internal ground connection.
     // Blocking read. Should always be 0!
@@ -221,9 +495,27 @@ public:
     // Blocking read.
     int readInternalReference(void);
 
-    // Raw 10-bit ADC reading from internal temperature sensor. (around 220?)
+    // Raw 10-bit ADC reading from internal temperature sensor. Typically
+    // about 290 at 25 C (314 mV), rising about 1 per degree.
     int readTempSensor(void);
 
+    // Chip temperature in hundredths of a degree C, integer arithmetic only:
+    // the datasheet's typical sensor curve, corrected by the calibration
+    // in EEPROM if there is one. Averages 4^oversampleBits readings (0..4:
+    // 1 to 256) for steps finer than the sensor's 1 degree or so.
+    int16_t getTemperatureCentiC(const uint8_t oversampleBits = 0);
+
+    // Calibration against a thermometer, at one or two temperatures: pass
+    // the true temperature in hundredths of a degree. The first corrects
+    // the offset; a second at least 5 degrees away from the one before
+    // also corrects the slope. Stored in EEPROM, loaded by begin().
+    // Returns the points used, 1 or 2.
+    uint8_t calibrateTemperature(const int16_t centiC);
+
+
+    // Get voltage at AVCC (ATmega's battery voltage) in millivolts.
+    // Average of 8 readings, integer arithmetic only. Blocking.
+    uint16_t getSupplyMillivolts(void);
 
     // Get voltage at AVCC (ATmega's battery voltage)
     // **as a floating point number**
@@ -231,15 +523,99 @@ public:
 
     float getSupplyVoltage(void);
 
+    // One-time calibration of the internal reference. Measure the supply
+    // voltage with a meter and pass it in millivolts. Works out the internal
+    // reference voltage, uses it and stores it in EEPROM: begin() loads it.
+    // Returns the internal reference voltage in millivolts, or 0 if it comes
+    // out beyond the data sheet's 1000 .. 1200 mV (volts passed, say): then
+    // nothing is used or stored.
+    uint16_t calibrateBandgap(const uint16_t supplyMillivolts);
+
+    // Background versions of readTempSensor() and getSupplyMillivolts():
+    // the done interrupt steps through the reference settling time, the
+    // discarded reading and the measurement while the sketch carries on.
+    // Check sensorReadingReady(), or pass a function to be called (from the
+    // interrupt) when done. Then getSensorReading(): the raw temperature
+    // reading, or the supply voltage in millivolts.
+    // Not while scanning, streaming or oversampling.
+    void     beginTempSensorRead(void (*done)(void) = 0);
+    void     beginSupplyVoltageRead(void (*done)(void) = 0);
+    bool     sensorReadingReady(void);
+    uint16_t getSensorReading(void);
+
 
 private:
-    float bandgapV = 1.1;
-    uint8_t _psbitsfromclock(const unsigned long);
-    void    _setClock(const unsigned long);
+    uint16_t _bandgapmV = 1100;    // internal reference voltage, millivolts
+    int16_t  _tempOffset = 0;      // temperature calibration: centi-C,
+    uint16_t _tempGain = 4096;     // and slope, 4096 = 1.0
+    int16_t  _tempPointTypical;    // last calibration point: curve's
+    int16_t  _tempPointC;          // temperature, and the true one
+    bool     _tempPointSet = false;
+    void     _loadCalibration(void);
+    uint16_t _supplyFromSum(const uint16_t);
+    uint8_t _osBits = 0;          // oversampling: extra bits over 10
+    void    _setOversampling(const uint8_t);
+    void    _setPrescaler(const uint8_t);
 
 }; // struct _M328P_ADC
 
 extern struct _M328P_ADC InternalADC;
 
+// Configuration change: collect settings in a copy, then commit() them to
+// the ADC together, with interrupts off for a few plain register stores.
+// No half-applied settings for a trigger or interrupt to see in between.
+//   ACPConfigChange c;            // starts from the ADC's current settings
+//   c.usePin(A3); c.referenceInternal(); c.bitDepth8(); c.speed4x();
+//   c.triggerOnTimer1Overflow(); c.interruptOnDone();
+//   c.commit();
+// Unlike InternalADC's functions, the triggers here leave the done
+// interrupt as it is: only interruptOnDone() / noInterruptOnDone() change
+// it. The ADC must be powered on. commit() doesn't wait for the internal
+// reference to settle.
+struct ACPConfigChange
+{
+    ACPConfigChange(void);                          // from the ADC's registers
+    ACPConfigChange(const InternalADCSettings s);   // from saved settings
+
+    void usePin(uint8_t pin);      // and disconnect its digital input
+    void freePin(uint8_t pin);     // internal ground, reconnect digital input
+    void reference(const int ref); // ACP_REF_AVCC, ACP_REF_INTERNAL, ACP_REF_EXTERNAL
+    void referenceDefault(void);
+    void referenceInternal(void);
+    void referenceExternal(void);
+    void bitDepth8(void);
+    void bitDepth10(void);
+    void speed1x(void);
+    void speed2x(void);
+    void speed4x(void);
+    void speed8x(void);
+    void singleReadingMode(void);
+    void freeRunningMode(void);
+    void triggerOnInputCapture(void);
+    void triggerOnInterrupt0(void);
+    void triggerOnTimer0Overflow(void);
+    void triggerOnTimer1CompareB(void);
+    void triggerOnTimer1Overflow(void);
+    void interruptOnDone(void);
+    void noInterruptOnDone(void);
+
+    void commit(void);
+    InternalADCSettings settings(void) const {return shadow;}
+
+    InternalADCSettings shadow;    // ADCSRA, ADCSRB, ADMUX to be
+    uint8_t             didr0;     // and DIDR0
+
+private:
+    void _trigger(const uint8_t source);
+};
+
+// Scoped power session: the ADC is on for as long as this exists.
+//   {ACPPowerSession on; a = InternalADC.analogRead(A0); b = ...;}
+struct ACPPowerSession
+{
+    ACPPowerSession()  {InternalADC.holdPower();}
+    ~ACPPowerSession() {InternalADC.releasePower();}
+};
+
 
 #endif